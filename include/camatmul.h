@@ -0,0 +1,98 @@
+/*
+ * camatmul: public C interface of the cache-aware / cache-oblivious matmul
+ * library. This header is the stable API: functions are only ever added, and
+ * existing signatures change only with CAMM_VERSION_MAJOR. All matrices are
+ * row-major with leading dimensions in elements, as in gemm() (src/gemm.h).
+ */
+#ifndef CAMATMUL_H
+#define CAMATMUL_H
+
+#include <stdint.h>
+
+#define CAMM_VERSION_MAJOR 1
+#define CAMM_VERSION_MINOR 0
+#define CAMM_VERSION_PATCH 0
+#define CAMM_VERSION (CAMM_VERSION_MAJOR * 10000 + CAMM_VERSION_MINOR * 100 + CAMM_VERSION_PATCH)
+
+/* Users of the static library on Windows define CAMM_STATIC (the CMake
+ * target camatmul::camatmul_static does so). */
+#if defined(_WIN32) && !defined(CAMM_STATIC)
+    #if defined(CAMM_BUILDING_LIBRARY)
+        #define CAMM_API __declspec(dllexport)
+    #else
+        #define CAMM_API __declspec(dllimport)
+    #endif
+#elif defined(__GNUC__)
+    #define CAMM_API __attribute__((visibility("default")))
+#else
+    #define CAMM_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum camm_transpose {
+    CAMM_NO_TRANS = 0,   /* op(X) = X   */
+    CAMM_TRANS    = 1    /* op(X) = X^T */
+} camm_transpose;
+
+typedef enum camm_status {
+    CAMM_OK               = 0,
+    CAMM_INVALID_ARGUMENT = 1,   /* negative size, short leading dimension or null pointer */
+    CAMM_OUT_OF_MEMORY    = 2,
+    CAMM_INTERNAL_ERROR   = 3
+} camm_status;
+
+/* CAMM_VERSION of the library actually loaded; compare with the header's. */
+CAMM_API int camm_version(void);
+
+/* Short English description of a status code. */
+CAMM_API const char* camm_status_string(camm_status status);
+
+/*
+ * C(MxN) = alpha * op(A) * op(B) + beta * C, with op(A) M x K and op(B) K x N.
+ * A is stored M x K (K x M when transA is CAMM_TRANS), B K x N (N x K). With
+ * beta == 0, C is not read and need not be initialised. Integer variants
+ * accumulate in the wider type named last; the result is undefined if any
+ * product or partial sum overflows that type, so keep the inputs in range.
+ * Runs on the library's shared worker pool; safe to call from several threads.
+ */
+CAMM_API camm_status camm_gemm_f32(camm_transpose transA, camm_transpose transB,
+                                   int M, int N, int K, float alpha,
+                                   const float* A, int lda, const float* B, int ldb,
+                                   float beta, float* C, int ldc);
+
+CAMM_API camm_status camm_gemm_f64(camm_transpose transA, camm_transpose transB,
+                                   int M, int N, int K, double alpha,
+                                   const double* A, int lda, const double* B, int ldb,
+                                   double beta, double* C, int ldc);
+
+/* int8 inputs, int32 accumulator and C. */
+CAMM_API camm_status camm_gemm_i8(camm_transpose transA, camm_transpose transB,
+                                  int M, int N, int K, int32_t alpha,
+                                  const int8_t* A, int lda, const int8_t* B, int ldb,
+                                  int32_t beta, int32_t* C, int ldc);
+
+/* int16 inputs, int32 accumulator and C. */
+CAMM_API camm_status camm_gemm_i16(camm_transpose transA, camm_transpose transB,
+                                   int M, int N, int K, int32_t alpha,
+                                   const int16_t* A, int lda, const int16_t* B, int ldb,
+                                   int32_t beta, int32_t* C, int ldc);
+
+CAMM_API camm_status camm_gemm_i32(camm_transpose transA, camm_transpose transB,
+                                   int M, int N, int K, int32_t alpha,
+                                   const int32_t* A, int lda, const int32_t* B, int ldb,
+                                   int32_t beta, int32_t* C, int ldc);
+
+/* int32 inputs, int64 accumulator and C (the i64 pair of --dtype). */
+CAMM_API camm_status camm_gemm_i64(camm_transpose transA, camm_transpose transB,
+                                   int M, int N, int K, int64_t alpha,
+                                   const int32_t* A, int lda, const int32_t* B, int ldb,
+                                   int64_t beta, int64_t* C, int ldc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAMATMUL_H */
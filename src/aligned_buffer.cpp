@@ -0,0 +1,216 @@
+#include "aligned_buffer.h"
+#include "task_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+#include <cstdint>
+#include <cstdlib>   // for posix_memalign, aligned_alloc, _aligned_malloc
+#include <cstring>   // for memset
+
+#ifdef __linux__
+    #include <sys/mman.h>
+#endif
+
+// Below this, a single memset is cheaper than a fork-join.
+static const std::size_t PARALLEL_TOUCH_BYTES = std::size_t(1) << 20;
+static const std::size_t PAGE_BYTES = 4096;
+static const std::size_t HUGE_PAGE_BYTES = std::size_t(2) << 20;
+
+namespace {
+
+std::atomic<bool> hugePagesEnabled{false};
+
+enum class Backing { HugeTlb, Thp };
+
+struct Mapping {
+    std::size_t bytes;
+    Backing backing;
+};
+
+// Buffers that came from mmap and must go back through munmap, with their size.
+std::mutex registryMutex;
+std::unordered_map<void*, Mapping> registry;
+
+} // namespace
+
+/**
+ * Each pool task zeroes a contiguous, page-aligned share of the buffer, so the
+ * page faults and stores of a large allocation are spread over the workers.
+ * pageBytes is the backing page size, so a huge page is never split between tasks.
+ */
+static void zero_parallel(void* ptr, std::size_t bytes, std::size_t pageBytes = PAGE_BYTES)
+{
+    if (bytes < PARALLEL_TOUCH_BYTES) {
+        std::memset(ptr, 0, bytes);
+        return;
+    }
+
+    char* base = static_cast<char*>(ptr);
+    int parts = TaskScheduler::instance().worker_count();
+    std::size_t chunk = (bytes / parts + pageBytes - 1) / pageBytes * pageBytes;
+    parallel_for(parts, [&](int p) {
+        std::size_t begin = std::min(bytes, p * chunk);
+        std::size_t end = std::min(bytes, begin + chunk);
+        std::memset(base + begin, 0, end - begin);
+    });
+}
+
+void zero_aligned_bytes(void* ptr, std::size_t bytes)
+{
+    zero_parallel(ptr, bytes);
+}
+
+#ifdef __linux__
+/**
+ * Explicit 2 MiB pages from the hugetlbfs pool first; if none are reserved,
+ * a 2 MiB aligned anonymous mapping marked MADV_HUGEPAGE so the kernel can
+ * back it with transparent huge pages. Returns nullptr if both fail.
+ */
+static void* map_huge(std::size_t bytes)
+{
+    std::size_t length = (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+
+    void* ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    Backing backing = Backing::HugeTlb;
+
+    if (ptr == MAP_FAILED) {
+        // Over-map by one huge page and trim both ends to a 2 MiB boundary.
+        void* raw = mmap(nullptr, length + HUGE_PAGE_BYTES, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            return nullptr;
+        std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw);
+        std::uintptr_t aligned = (start + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+        if (aligned > start)
+            munmap(raw, aligned - start);
+        std::size_t tail = (start + length + HUGE_PAGE_BYTES) - (aligned + length);
+        if (tail > 0)
+            munmap(reinterpret_cast<void*>(aligned + length), tail);
+
+        ptr = reinterpret_cast<void*>(aligned);
+        madvise(ptr, length, MADV_HUGEPAGE);
+        backing = Backing::Thp;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry[ptr] = Mapping{ length, backing };
+    return ptr;
+}
+#endif
+
+void set_huge_pages(bool enabled)
+{
+    hugePagesEnabled.store(enabled);
+}
+
+bool huge_pages_enabled()
+{
+    return hugePagesEnabled.load();
+}
+
+/**
+ * Live mappings from the registry; the resident THP amount is the
+ * AnonHugePages total of /proc/self/smaps (whole process, in kB there).
+ */
+HugePageStats huge_page_stats()
+{
+    HugePageStats stats = {};
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& entry : registry) {
+            if (entry.second.backing == Backing::HugeTlb)
+                stats.hugetlb_bytes += entry.second.bytes;
+            else
+                stats.madvised_bytes += entry.second.bytes;
+        }
+    }
+
+#ifdef __linux__
+    std::ifstream smaps("/proc/self/smaps");
+    std::string key;
+    while (smaps >> key) {
+        if (key == "AnonHugePages:") {
+            std::size_t kb = 0;
+            smaps >> kb;
+            stats.thp_resident_bytes += kb * 1024;
+        }
+        smaps.ignore(1 << 16, '\n');
+    }
+#endif
+    return stats;
+}
+
+/**
+ * Allocates a 1D buffer of `bytes` bytes, 64-byte aligned, zeroed unless
+ * `zeroed` is false (for storage the caller overwrites before reading).
+ * Throws std::bad_alloc when no memory is left.
+ * With huge pages enabled, buffers of at least one huge page are mmap'd
+ * (see map_huge) and fall back to the normal path if that fails.
+ */
+void* allocate_aligned_bytes(std::size_t bytes, bool zeroed)
+{
+    void* ptr = nullptr;
+
+#ifdef __linux__
+    if (hugePagesEnabled.load() && bytes >= HUGE_PAGE_BYTES) {
+        ptr = map_huge(bytes);
+        if (ptr) {
+            if (zeroed)
+                zero_parallel(ptr, bytes, HUGE_PAGE_BYTES);
+            return ptr;
+        }
+    }
+#endif
+
+#if defined(_MSC_VER)
+    // Windows + MSVC
+    ptr = _aligned_malloc(bytes, 64);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+#elif defined(__APPLE__) || defined(__linux__)
+    // Unix-like systems
+    const std::size_t alignment = 64;
+    if (posix_memalign(&ptr, alignment, bytes) != 0) {
+        throw std::bad_alloc();
+    }
+#else
+    // Fallback: C++17 aligned_alloc (non-MSVC)
+    ptr = std::aligned_alloc(64, bytes);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+#endif
+
+    if (zeroed)
+        zero_parallel(ptr, bytes);
+    return ptr;
+}
+
+void free_aligned_bytes(void* ptr)
+{
+#ifdef __linux__
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto it = registry.find(ptr);
+        if (it != registry.end()) {
+            munmap(ptr, it->second.bytes);
+            registry.erase(it);
+            return;
+        }
+    }
+#endif
+
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
@@ -0,0 +1,30 @@
+#ifndef ALIGNED_BUFFER_H
+#define ALIGNED_BUFFER_H
+
+#include <cstddef>
+
+// Raw 64-byte aligned storage shared by Matrix<T> and the 1D kernels.
+// Throws std::bad_alloc on allocation failure.
+// Zeroed unless `zeroed` is false; large buffers are zeroed in parallel on the
+// worker pool.
+void* allocate_aligned_bytes(std::size_t bytes, bool zeroed = true);
+void free_aligned_bytes(void* ptr);
+
+// Zeroes an existing buffer, in parallel on the worker pool when it is large.
+void zero_aligned_bytes(void* ptr, std::size_t bytes);
+
+// Huge-page mode (--hugepages, Linux only): buffers of 2 MiB and more are
+// mapped with MAP_HUGETLB, or with madvise(MADV_HUGEPAGE) when no explicit
+// huge pages are reserved. Affects allocations made after the call.
+void set_huge_pages(bool enabled);
+bool huge_pages_enabled();
+
+// What huge-page mode actually obtained, for buffers that are currently live.
+struct HugePageStats {
+    std::size_t hugetlb_bytes;       // mapped from the explicit 2 MiB page pool
+    std::size_t madvised_bytes;      // MADV_HUGEPAGE fallback mappings
+    std::size_t thp_resident_bytes;  // AnonHugePages of the whole process
+};
+HugePageStats huge_page_stats();
+
+#endif // ALIGNED_BUFFER_H
@@ -0,0 +1,198 @@
+#include "async_matmul.h"
+#include "matmul_types.h"
+#include "packed_matmul.h"
+#include "task_scheduler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Tile of C handed to one pool task: whole micro-tiles of the packed kernel,
+// large enough that packing its A rows and B columns is a few percent of the
+// work, small enough that a 1024^2 product still gives every worker tiles.
+constexpr int TILE_ROWS = 32 * PACK_MR;
+constexpr int TILE_COLS = 16 * PACK_NR;
+
+struct Job {
+    std::function<void(int)> run;   // computes tile t
+    int tiles = 0;
+    int maxTasks = 0;               // 0: fair share only
+    int next = 0;                   // first tile not handed out yet
+    int running = 0;
+    std::exception_ptr error;
+    std::promise<void> done;
+};
+
+/**
+ * The jobs in flight and the pool tasks ("slots") working on them. A slot
+ * claims one tile, runs it and re-posts itself while work is left, so pool
+ * tasks stay one tile long and a thread helping in TaskGroup::wait() is never
+ * held up by a whole job.
+ */
+class JobQueue {
+public:
+    // Never destroyed: slots may still run while statics are torn down at exit.
+    static JobQueue& instance()
+    {
+        static JobQueue* queue = new JobQueue();
+        return *queue;
+    }
+
+    std::future<void> submit(std::shared_ptr<Job> job)
+    {
+        std::future<void> future = job->done.get_future();
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+        fill_slots();
+        return future;
+    }
+
+    int jobs_in_flight()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return static_cast<int>(jobs_.size());
+    }
+
+private:
+    // Jobs that still have tiles to hand out.
+    int waiting_jobs() const
+    {
+        return static_cast<int>(std::count_if(jobs_.begin(), jobs_.end(),
+                                               [](const auto& job) { return job->next < job->tiles; }));
+    }
+
+    // Fair share: the pool split evenly over the jobs with tiles left.
+    int budget(const Job& job, int workers, int waiting) const
+    {
+        int share = (workers + std::max(waiting, 1) - 1) / std::max(waiting, 1);
+        return job.maxTasks > 0 ? std::min(share, job.maxTasks) : share;
+    }
+
+    // Next job, round-robin from cursor_, that may start another tile.
+    std::shared_ptr<Job> claim()
+    {
+        const int workers = TaskScheduler::instance().worker_count();
+        const int waiting = waiting_jobs();
+        for (std::size_t i = 0; i < jobs_.size(); ++i) {
+            std::size_t index = (cursor_ + i) % jobs_.size();
+            const std::shared_ptr<Job>& job = jobs_[index];
+            if (job->next < job->tiles && job->running < budget(*job, workers, waiting)) {
+                cursor_ = index + 1;
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    // Posts slots until every tile that may start now has one (at most one per worker).
+    void fill_slots()
+    {
+        TaskScheduler& pool = TaskScheduler::instance();
+        const int workers = pool.worker_count();
+        const int waiting = waiting_jobs();
+        int wanted = 0;
+        for (const auto& job : jobs_)
+            wanted += std::min(job->tiles - job->next, std::max(0, budget(*job, workers, waiting) - job->running));
+        wanted = std::min(workers, slots_ + wanted);
+        for (; slots_ < wanted; ++slots_)
+            pool.post([this] { run_slot(); });
+    }
+
+    void run_slot()
+    {
+        std::shared_ptr<Job> job;
+        int tile = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job = claim();
+            if (!job) {
+                --slots_;
+                return;
+            }
+            tile = job->next++;
+            ++job->running;
+        }
+
+        std::exception_ptr error;
+        try {
+            job->run(tile);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        bool finished = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --job->running;
+            if (error && !job->error) {
+                job->error = error;
+                job->next = job->tiles;   // skip the tiles not started yet
+            }
+            if (job->next == job->tiles && job->running == 0) {
+                jobs_.erase(std::find(jobs_.begin(), jobs_.end(), job));
+                finished = true;
+            }
+            // This slot goes round again; finishing a job may also raise the others' budgets.
+            --slots_;
+            fill_slots();
+        }
+        if (finished) {
+            if (job->error)
+                job->done.set_exception(job->error);
+            else
+                job->done.set_value();
+        }
+    }
+
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<Job>> jobs_;
+    std::size_t cursor_ = 0;
+    int slots_ = 0;   // slots posted to the pool and not yet retired
+};
+
+} // namespace
+
+template <typename T, typename Acc>
+std::future<void> gemm_async(Trans transA, Trans transB, int M, int N, int K, Acc alpha,
+                             const T* A, int lda,
+                             const T* B, int ldb,
+                             Acc beta, Acc* C, int ldc,
+                             GemmAlgo algo, int threadCount)
+{
+    auto job = std::make_shared<Job>();
+    if (M <= 0 || N <= 0) {
+        job->done.set_value();
+        return job->done.get_future();
+    }
+
+    const int tilesN = (N + TILE_COLS - 1) / TILE_COLS;
+    job->tiles = (M + TILE_ROWS - 1) / TILE_ROWS * tilesN;
+    job->maxTasks = threadCount;
+    job->run = [=](int t) {
+        int i0 = t / tilesN * TILE_ROWS;
+        int j0 = t % tilesN * TILE_COLS;
+        // Rows i0.. of op(A) and columns j0.. of op(B) in the stored matrices.
+        const T* a = transA == Trans::Yes ? A + i0 : A + static_cast<std::ptrdiff_t>(i0) * lda;
+        const T* b = transB == Trans::Yes ? B + static_cast<std::ptrdiff_t>(j0) * ldb : B + j0;
+        gemm<T, Acc>(transA, transB, std::min(TILE_ROWS, M - i0), std::min(TILE_COLS, N - j0), K, alpha,
+                     a, lda, b, ldb, beta, C + static_cast<std::ptrdiff_t>(i0) * ldc + j0, ldc, algo, 1);
+    };
+    return JobQueue::instance().submit(std::move(job));
+}
+
+int async_jobs_in_flight()
+{
+    return JobQueue::instance().jobs_in_flight();
+}
+
+#define CAMM_INSTANTIATE_ASYNC(T, Acc)                                                              \
+    template std::future<void> gemm_async<T, Acc>(Trans, Trans, int, int, int, Acc, const T*, int, \
+                                                  const T*, int, Acc, Acc*, int, GemmAlgo, int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_ASYNC)
@@ -0,0 +1,36 @@
+#ifndef ASYNC_MATMUL_H
+#define ASYNC_MATMUL_H
+
+#include "gemm.h"
+
+#include <future>
+
+/**
+ * Non-blocking gemm(): queues C = alpha * op(A) * op(B) + beta * C and returns
+ * at once. The future becomes ready when C is complete and rethrows anything
+ * a tile threw (std::bad_alloc, say). A, B and C must stay alive and C
+ * untouched until then.
+ *
+ * Every submitted job is cut into tiles of C that run on the shared pool
+ * (TaskScheduler::instance()), one pool task per tile. The tiles of all jobs
+ * in flight are handed out round-robin, so several small jobs interleave with
+ * each other and with a large one instead of queueing behind it. A job may
+ * occupy at most workers / (jobs with tiles left) pool workers at once,
+ * rounded up, and at most threadCount when that is > 0. Each tile runs gemm()
+ * with `algo` on a single task.
+ *
+ * Do not wait on the future from inside a pool task: the tiles need the
+ * worker that would be blocked. Instantiated for every type pair in
+ * matmul_types.h.
+ */
+template <typename T, typename Acc>
+std::future<void> gemm_async(Trans transA, Trans transB, int M, int N, int K, Acc alpha,
+                             const T* A, int lda,
+                             const T* B, int ldb,
+                             Acc beta, Acc* C, int ldc,
+                             GemmAlgo algo = GemmAlgo::Auto, int threadCount = 0);
+
+// Jobs submitted through gemm_async that have not completed yet.
+int async_jobs_in_flight();
+
+#endif // ASYNC_MATMUL_H
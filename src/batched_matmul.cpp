@@ -0,0 +1,102 @@
+#include "batched_matmul.h"
+#include "matmul_types.h"
+#include "packed_matmul.h"
+#include "simd_kernels.h"
+#include "task_scheduler.h"
+
+#include <algorithm>
+
+namespace {
+
+// Work below which another task costs more to dispatch than it saves.
+constexpr double MIN_TASK_OPS = 1 << 18;
+
+// Shapes without a fixed-size kernel above this many multiply-adds go through
+// single-task packed_gemm, whose packing pays off from about 16^3.
+constexpr long long PACKED_MIN_MACS = 16 * 16 * 16;
+
+/**
+ * Runs product(i) for i in [0, batch) on up to threadCount pool tasks, each
+ * taking one contiguous range so neighbouring matrices stay on one core.
+ */
+template <typename Product>
+void for_each_product(int M, int N, int K, int batch, int threadCount, Product&& product)
+{
+    if (batch <= 0 || M <= 0 || N <= 0 || K <= 0)
+        return;
+    if (threadCount <= 0)
+        threadCount = TaskScheduler::instance().worker_count();
+    double ops = 2.0 * M * N * K * batch;
+    int tasks = std::min({ threadCount, batch, std::max(1, static_cast<int>(ops / MIN_TASK_OPS)) });
+
+    parallel_for(tasks, [&](int t) {
+        int begin = static_cast<int>(static_cast<long long>(batch) * t / tasks);
+        int end = static_cast<int>(static_cast<long long>(batch) * (t + 1) / tasks);
+        for (int i = begin; i < end; ++i)
+            product(i);
+    });
+}
+
+// One product: the fixed-size kernel when the shape has one, else the axpy
+// loop (tiny shapes) or packed_gemm on the calling thread.
+template <typename T, typename Acc>
+struct SmallProduct {
+    SmallGemmKernel<T, Acc> fixed;
+    void (*axpy)(Acc*, const T*, Acc, int);
+    int M, N, K, lda, ldb, ldc;
+
+    SmallProduct(int M_, int N_, int K_, int lda_, int ldb_, int ldc_)
+        : fixed(M_ == N_ && N_ == K_ ? small_gemm_kernel<T, Acc>(M_) : nullptr),
+          axpy(simd_kernels<T, Acc>().axpy),
+          M(M_), N(N_), K(K_), lda(lda_), ldb(ldb_), ldc(ldc_) {}
+
+    void operator()(const T* A, const T* B, Acc* C) const
+    {
+        if (fixed) {
+            fixed(A, lda, B, ldb, C, ldc);
+            return;
+        }
+        if (static_cast<long long>(M) * N * K > PACKED_MIN_MACS) {
+            packed_gemm<T, Acc>(M, N, K, A, lda, B, ldb, C, ldc, 1);
+            return;
+        }
+        for (int i = 0; i < M; ++i)
+            for (int k = 0; k < K; ++k)
+                axpy(C + static_cast<std::ptrdiff_t>(i) * ldc, B + static_cast<std::ptrdiff_t>(k) * ldb,
+                     static_cast<Acc>(A[static_cast<std::ptrdiff_t>(i) * lda + k]), N);
+    }
+};
+
+} // namespace
+
+template <typename T, typename Acc>
+void batched_matmul(int M, int N, int K,
+                    const T* const* A, int lda,
+                    const T* const* B, int ldb,
+                    Acc* const* C, int ldc,
+                    int batch, int threadCount)
+{
+    const SmallProduct<T, Acc> product(M, N, K, lda, ldb, ldc);
+    for_each_product(M, N, K, batch, threadCount, [&](int i) { product(A[i], B[i], C[i]); });
+}
+
+template <typename T, typename Acc>
+void batched_matmul_strided(int M, int N, int K,
+                            const T* A, int lda, std::ptrdiff_t strideA,
+                            const T* B, int ldb, std::ptrdiff_t strideB,
+                            Acc* C, int ldc, std::ptrdiff_t strideC,
+                            int batch, int threadCount)
+{
+    const SmallProduct<T, Acc> product(M, N, K, lda, ldb, ldc);
+    for_each_product(M, N, K, batch, threadCount, [&](int i) {
+        product(A + i * strideA, B + i * strideB, C + i * strideC);
+    });
+}
+
+#define CAMM_INSTANTIATE_BATCHED_MATMUL(T, Acc)                                                \
+    template void batched_matmul<T, Acc>(int, int, int, const T* const*, int, const T* const*, \
+                                         int, Acc* const*, int, int, int);                     \
+    template void batched_matmul_strided<T, Acc>(int, int, int, const T*, int, std::ptrdiff_t, \
+                                                 const T*, int, std::ptrdiff_t, Acc*, int,     \
+                                                 std::ptrdiff_t, int, int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_BATCHED_MATMUL)
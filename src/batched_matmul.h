@@ -0,0 +1,33 @@
+#ifndef BATCHED_MATMUL_H
+#define BATCHED_MATMUL_H
+
+#include <cstddef>
+
+// Many independent small products C[i] += A[i] * B[i], all MxK times KxN,
+// row-major with leading dimensions lda/ldb/ldc. Square shapes whose edge is
+// in SMALL_GEMM_EDGES (simd_kernels.h) run a fixed-size kernel; any other
+// shape runs the axpy loop, or single-task packed_gemm once it is larger
+// than 16 x 16 x 16. The batch is split into contiguous ranges across
+// pool tasks and each product runs whole on one thread, so the fixed-size
+// path has no packing, allocation or blocking. threadCount <= 0 uses every
+// pool worker; small batches use fewer tasks so dispatch does not outweigh
+// the work.
+// Instantiated for every type pair in matmul_types.h.
+
+// Arrays of batch pointers.
+template <typename T, typename Acc>
+void batched_matmul(int M, int N, int K,
+                    const T* const* A, int lda,
+                    const T* const* B, int ldb,
+                    Acc* const* C, int ldc,
+                    int batch, int threadCount = 0);
+
+// Matrix i starts at A + i * strideA (B, C likewise; strides in elements).
+template <typename T, typename Acc>
+void batched_matmul_strided(int M, int N, int K,
+                            const T* A, int lda, std::ptrdiff_t strideA,
+                            const T* B, int ldb, std::ptrdiff_t strideB,
+                            Acc* C, int ldc, std::ptrdiff_t strideC,
+                            int batch, int threadCount = 0);
+
+#endif // BATCHED_MATMUL_H
@@ -0,0 +1,56 @@
+#include "benchmark_harness.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Linear interpolation between closest ranks of sorted data (q in [0, 1]).
+double quantile(const std::vector<double>& sorted, double q)
+{
+    double pos = q * (sorted.size() - 1);
+    std::size_t lo = static_cast<std::size_t>(pos);
+    std::size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (pos - lo) * (sorted[hi] - sorted[lo]);
+}
+
+} // namespace
+
+SampleStats summarize(const std::vector<Measurement>& samples)
+{
+    SampleStats stats;
+    if (samples.empty())
+        return stats;
+
+    std::vector<double> times;
+    for (const Measurement& sample : samples)
+        times.push_back(sample.ms);
+    std::sort(times.begin(), times.end());
+
+    double sum = 0;
+    for (double t : times)
+        sum += t;
+
+    stats.count = static_cast<int>(times.size());
+    stats.min = times.front();
+    stats.median = quantile(times, 0.5);
+    stats.mean = sum / stats.count;
+    stats.p95 = quantile(times, 0.95);
+    if (stats.count > 1) {
+        double squares = 0;
+        for (double t : times)
+            squares += (t - stats.mean) * (t - stats.mean);
+        stats.stddev = std::sqrt(squares / (stats.count - 1));
+    }
+    return stats;
+}
+
+const Measurement& median_sample(const std::vector<Measurement>& samples)
+{
+    std::vector<std::size_t> order(samples.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&](std::size_t a, std::size_t b) { return samples[a].ms < samples[b].ms; });
+    return samples[order[(order.size() - 1) / 2]];
+}
@@ -0,0 +1,88 @@
+#ifndef BENCHMARK_HARNESS_H
+#define BENCHMARK_HARNESS_H
+
+#include <chrono>
+#include <vector>
+
+#include "perf_counters.h"
+
+// Wall time and hardware counters of one kernel run.
+struct Measurement {
+    double ms;
+    PerfSample perf;
+};
+
+/**
+ * Runs fn once under `counters`, opened once by the caller for all its
+ * repetitions. Counters are enabled before and read after the timed region,
+ * so only enabling and disabling them is timed.
+ */
+template <typename Fn>
+Measurement measure(PerfCounters& counters, Fn&& fn)
+{
+    using Clock = std::chrono::steady_clock;
+    counters.start();
+    auto start = Clock::now();
+    fn();
+    auto end = Clock::now();
+
+    Measurement result;
+    result.perf = counters.stop();
+    result.ms = std::chrono::duration<double, std::milli>(end - start).count();
+    return result;
+}
+
+// How often each configuration runs: untimed warm-up runs (page faults, pool
+// wake-up, caches and branch predictors), then the timed repetitions.
+struct RepetitionPlan {
+    int warmup = 1;
+    int iterations = 3;
+};
+
+// Summary of the repetitions of one configuration, in milliseconds.
+struct SampleStats {
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double stddev = 0;   // sample standard deviation, 0 for a single run
+    double p95 = 0;      // linearly interpolated 95th percentile
+    int count = 0;
+};
+
+SampleStats summarize(const std::vector<Measurement>& samples);
+
+// The repetition whose time is the median (the lower one for even counts);
+// its counters stand for the configuration.
+const Measurement& median_sample(const std::vector<Measurement>& samples);
+
+/**
+ * plan.warmup untimed calls, then plan.iterations measured ones. reset()
+ * runs before every call, outside the timed region (e.g. zeroing C).
+ * check(repetition) runs after every measured call, also untimed; when it
+ * returns false the repetitions stop there.
+ */
+template <typename Reset, typename Fn, typename Check>
+std::vector<Measurement> run_repeated(const RepetitionPlan& plan, Reset&& reset, Fn&& fn, Check&& check)
+{
+    for (int w = 0; w < plan.warmup; ++w) {
+        reset();
+        fn();
+    }
+    PerfCounters counters;
+    std::vector<Measurement> samples;
+    for (int r = 0; r < plan.iterations; ++r) {
+        reset();
+        samples.push_back(measure(counters, fn));
+        if (!check(r))
+            break;
+    }
+    return samples;
+}
+
+template <typename Reset, typename Fn>
+std::vector<Measurement> run_repeated(const RepetitionPlan& plan, Reset&& reset, Fn&& fn)
+{
+    return run_repeated(plan, reset, fn, [](int) { return true; });
+}
+
+#endif // BENCHMARK_HARNESS_H
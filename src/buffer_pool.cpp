@@ -0,0 +1,144 @@
+#include "buffer_pool.h"
+#include "aligned_buffer.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Pool {
+    std::mutex mutex;
+    std::unordered_map<std::size_t, std::vector<void*>> freeLists;  // class bytes -> buffers
+    std::unordered_map<void*, std::size_t> outstanding;             // buffer -> class bytes
+    std::size_t limit = std::size_t(1) << 30;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t cachedBytes = 0;
+    std::size_t liveBytes = 0;
+
+    ~Pool() {
+        for (auto& entry : freeLists)
+            for (void* ptr : entry.second)
+                free_aligned_bytes(ptr);
+    }
+};
+
+Pool& pool()
+{
+    static Pool instance;
+    return instance;
+}
+
+/**
+ * Smallest m * 2^e >= bytes with m in {4, 5, 6, 7}, at least one cache line.
+ */
+std::size_t size_class(std::size_t bytes)
+{
+    std::size_t size = 64;
+    while (size < bytes) {
+        // Step from m * 2^e to (m + 1) * 2^e, or from 7 * 2^e to 4 * 2^(e + 1).
+        std::size_t unit = size;
+        while (unit & (unit - 1))
+            unit &= unit - 1;          // highest set bit = 4 * 2^e
+        size += unit / 4;
+    }
+    return size;
+}
+
+} // namespace
+
+void* acquire_buffer(std::size_t bytes, bool zeroed)
+{
+    std::size_t classBytes = size_class(bytes);
+    Pool& p = pool();
+
+    void* ptr = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        auto it = p.freeLists.find(classBytes);
+        if (it != p.freeLists.end() && !it->second.empty()) {
+            ptr = it->second.back();
+            it->second.pop_back();
+            p.cachedBytes -= classBytes;
+            ++p.hits;
+        } else {
+            ++p.misses;
+        }
+        p.liveBytes += classBytes;
+    }
+
+    if (ptr) {
+        if (zeroed)
+            zero_aligned_bytes(ptr, bytes);
+    } else {
+        try {
+            ptr = allocate_aligned_bytes(classBytes, zeroed);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(p.mutex);
+            p.liveBytes -= classBytes;
+            throw;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(p.mutex);
+    p.outstanding[ptr] = classBytes;
+    return ptr;
+}
+
+void release_buffer(void* ptr)
+{
+    if (!ptr)
+        return;
+    Pool& p = pool();
+
+    {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        auto it = p.outstanding.find(ptr);
+        if (it == p.outstanding.end()) {
+            std::cerr << "release_buffer: " << ptr << " was not acquired from the pool"
+                      << " or was already released\n";
+            std::abort();
+        }
+        std::size_t classBytes = it->second;
+        p.outstanding.erase(it);
+        p.liveBytes -= classBytes;
+
+        if (p.cachedBytes + classBytes <= p.limit) {
+            p.freeLists[classBytes].push_back(ptr);
+            p.cachedBytes += classBytes;
+            return;
+        }
+    }
+    free_aligned_bytes(ptr);
+}
+
+void set_buffer_pool_limit(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(pool().mutex);
+    pool().limit = bytes;
+}
+
+void trim_buffer_pool()
+{
+    std::vector<void*> buffers;
+    {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        for (auto& entry : p.freeLists)
+            buffers.insert(buffers.end(), entry.second.begin(), entry.second.end());
+        p.freeLists.clear();
+        p.cachedBytes = 0;
+    }
+    for (void* ptr : buffers)
+        free_aligned_bytes(ptr);
+}
+
+BufferPoolStats buffer_pool_stats()
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    return BufferPoolStats{ p.hits, p.misses, p.cachedBytes, p.liveBytes };
+}
@@ -0,0 +1,34 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <cstddef>
+
+// Process-wide recycler for aligned matrix storage. Requests are rounded up
+// to a size class (four classes per power of two, so at most ~19% slack);
+// released buffers are kept per class and handed out again to the next
+// request of that class, skipping the page faults and first-touch of a fresh
+// allocation. Misses go to allocate_aligned_bytes, so huge-page mode applies.
+// Thread-safe.
+
+// 64-byte aligned storage of at least `bytes` bytes, zeroed when `zeroed` is set.
+// Throws std::bad_alloc when a miss cannot be allocated.
+void* acquire_buffer(std::size_t bytes, bool zeroed = true);
+// Returns a buffer from acquire_buffer to the pool (nullptr is ignored).
+// Aborts on a pointer the pool did not hand out, or one released twice.
+void release_buffer(void* ptr);
+
+// Upper bound on bytes kept cached; releases beyond it free the buffer.
+// Default 1 GiB. Lowering it does not evict; call trim_buffer_pool for that.
+void set_buffer_pool_limit(std::size_t bytes);
+// Frees every cached buffer.
+void trim_buffer_pool();
+
+struct BufferPoolStats {
+    std::size_t hits;          // acquires served from the cache
+    std::size_t misses;        // acquires that allocated fresh storage
+    std::size_t cached_bytes;  // bytes held in the cache right now
+    std::size_t live_bytes;    // bytes handed out and not yet released
+};
+BufferPoolStats buffer_pool_stats();
+
+#endif // BUFFER_POOL_H
@@ -1,21 +1,42 @@
 #include "cache_aware_matmul.h"
+#include "simd_kernels.h"
+#include "matmul_types.h"
+#include "tuning.h"
 #include <algorithm>
+#include <cmath>
 
-void cache_aware_matmul(const std::vector<std::vector<int>>& A,
-                        const std::vector<std::vector<int>>& B,
-                        std::vector<std::vector<int>>& C,
-                        int cacheLineSize, int l1CacheSize) {
-    int n = A.size();
-    // Compute block size: assume an int is sizeof(int) bytes.
-    int blockSize = l1CacheSize / (3 * sizeof(int)); // factor 3: A, B, C blocks
+template <typename T, typename Acc>
+int cache_aware_block_size(int M, int N, int K, int cacheLineSize, int l1CacheSize) {
+    // Tile edge b such that a b x b tile of A, of B and of C fit in L1
+    // together, rounded down to whole cache lines of C. --tune can override it.
+    int lineElems = std::max(1, cacheLineSize / static_cast<int>(sizeof(Acc)));
+    int fit = static_cast<int>(std::sqrt(l1CacheSize / double(2 * sizeof(T) + sizeof(Acc))));
+    int blockSize = std::max(8, fit / lineElems * lineElems);
+    blockSize = tuned_value(TuneKey::CacheAwareBlock, dtype_of<T, Acc>(), M, N, K, blockSize);
 
-    blockSize = std::max(1, std::min(blockSize, n));
+    return std::max(1, std::min(blockSize, std::max({M, N, K})));
+}
+
+template <typename T, typename Acc>
+void cache_aware_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                        int cacheLineSize, int l1CacheSize, int blockSize) {
+    const auto axpy = simd_kernels<T, Acc>().axpy;
+    int M = C.rows(), N = C.cols(), K = A.cols();
+    if (try_fixed_matmul<T, Acc>(M, N, K, A.data(), A.ld(), B.data(), B.ld(), C.data(), C.ld()))
+        return;
+    if (blockSize <= 0)
+        blockSize = cache_aware_block_size<T, Acc>(M, N, K, cacheLineSize, l1CacheSize);
 
-    for (int ii = 0; ii < n; ii += blockSize)
-        for (int jj = 0; jj < n; jj += blockSize)
-            for (int kk = 0; kk < n; kk += blockSize)
-                for (int i = ii; i < std::min(ii+blockSize, n); ++i)
-                    for (int k = kk; k < std::min(kk+blockSize, n); ++k)
-                        for (int j = jj; j < std::min(jj+blockSize, n); ++j)
-                            C[i][j] += A[i][k] * B[k][j];
+    for (int ii = 0; ii < M; ii += blockSize)
+        for (int jj = 0; jj < N; jj += blockSize)
+            for (int kk = 0; kk < K; kk += blockSize)
+                for (int i = ii; i < std::min(ii+blockSize, M); ++i)
+                    for (int k = kk; k < std::min(kk+blockSize, K); ++k)
+                        axpy(&C(i, jj), &B(k, jj), static_cast<Acc>(A(i, k)), std::min(jj+blockSize, N) - jj);
 }
+
+#define CAMM_INSTANTIATE_CACHE_AWARE(T, Acc)                                                    \
+    template int cache_aware_block_size<T, Acc>(int, int, int, int, int);                       \
+    template void cache_aware_matmul<T, Acc>(MatrixView<const T>, MatrixView<const T>,          \
+                                             MatrixView<Acc>, int, int, int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_CACHE_AWARE)
@@ -1,11 +1,16 @@
 #ifndef CACHE_AWARE_MATMUL_H
 #define CACHE_AWARE_MATMUL_H
 
-#include <vector>
+#include "matrix.h"
 
-void cache_aware_matmul(const std::vector<std::vector<int>>& A,
-                        const std::vector<std::vector<int>>& B,
-                        std::vector<std::vector<int>>& C,
-                        int cacheLineSize, int l1CacheSize);
+// Tile edge cache_aware_matmul uses for an M x K x N product: the tuned value,
+// else the largest edge whose A, B and C tiles fit in L1 together.
+template <typename T, typename Acc>
+int cache_aware_block_size(int M, int N, int K, int cacheLineSize, int l1CacheSize);
+
+// blockSize <= 0 takes cache_aware_block_size.
+template <typename T, typename Acc>
+void cache_aware_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                        int cacheLineSize, int l1CacheSize, int blockSize = 0);
 
 #endif // CACHE_AWARE_MATMUL_H
@@ -1,94 +1,86 @@
 #include "cache_aware_matmul_1D.h"
+#include "simd_kernels.h"
+#include "matmul_types.h"
+#include "morton_matrix.h"
+#include "task_scheduler.h"
+#include "tuning.h"
 
-#include <cstdlib>   // for posix_memalign, aligned_alloc, _aligned_malloc
-#include <cstring>   // for memset
-#include <iostream>
 #include <algorithm> 
-#include <thread>
+#include <atomic>
+#include <utility>
 #include <vector>
 
-/**
- * Allocates a 1D array of (n*n) ints, 64-byte aligned.
- */
-int* allocate_aligned_matrix(std::size_t n)
-{
-    std::size_t bytes = n * n * sizeof(int);
-    void* ptr = nullptr;
-
-#if defined(_MSC_VER)
-    // Windows + MSVC
-    ptr = _aligned_malloc(bytes, 64);
-    if (!ptr) {
-        std::cerr << "_aligned_malloc failed!\n";
-        std::abort();
-    }
-#elif defined(__APPLE__) || defined(__linux__)
-    // Unix-like systems
-    const std::size_t alignment = 64;
-    if (posix_memalign(&ptr, alignment, bytes) != 0) {
-        std::cerr << "posix_memalign failed!\n";
-        std::abort();
-    }
-#else
-    // Fallback: C++17 aligned_alloc (non-MSVC)
-    ptr = std::aligned_alloc(64, bytes);
-    if (!ptr) {
-        std::cerr << "aligned_alloc failed!\n";
-        std::abort();
-    }
-#endif
-
-    std::memset(ptr, 0, bytes);
-    return static_cast<int*>(ptr);
-}
-
-void free_aligned_matrix(int* ptr)
+template <typename T, typename Acc>
+int cache_aware_1D_tile_size(int M, int N, int K, int tileSize)
 {
-#if defined(_MSC_VER)
-    _aligned_free(ptr);
-#else
-    free(ptr);
-#endif
+    if (tileSize <= 0)
+        tileSize = tuned_value(TuneKey::Tile1D, dtype_of<T, Acc>(), M, N, K, 64);
+    return std::max(16, (tileSize + 15) / 16 * 16);
 }
 
 /**
- * Parallel blocked matmul with std::thread.
+ * Parallel blocked matmul over a 2D grid of blockSize x blockSize tiles of C.
+ * Workers (tasks on the persistent pool) claim tiles through a shared atomic
+ * counter until none are left. Tile edges are rounded up to multiples of 16
+ * elements (a full 64-byte line for 4-byte Acc), so with cache-line aligned
+ * rows no two workers ever write the same line of C.
  */
-void cache_aware_matmul_1D(const int* A, const int* B, int* C, int n, int threadCount)
+template <typename T, typename Acc>
+void cache_aware_matmul_1D(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                           int threadCount, TileOrder order, int tileSize)
 {
-    int blockSize = 64;
+    int M = C.rows(), N = C.cols(), K = A.cols();
+    if (C.empty())
+        return;
+    if (try_fixed_matmul<T, Acc>(M, N, K, A.data(), A.ld(), B.data(), B.ld(), C.data(), C.ld()))
+        return;
+    if (threadCount <= 0)
+        threadCount = tuned_threads(TuneKey::Threads1D, dtype_of<T, Acc>(), M, N, K);
+    const int blockSize = cache_aware_1D_tile_size<T, Acc>(M, N, K, tileSize);
+    const auto axpy = simd_kernels<T, Acc>().axpy;
 
-    auto worker = [&](int threadId)
-    {
-        for (int ii = threadId * blockSize; ii < n; ii += blockSize * threadCount) {
-            for (int jj = 0; jj < n; jj += blockSize) {
-                for (int kk = 0; kk < n; kk += blockSize) {
+    int tilesM = (M + blockSize - 1) / blockSize;
+    int tilesN = (N + blockSize - 1) / blockSize;
+
+    std::vector<std::pair<int, int>> tiles;
+    tiles.reserve(static_cast<std::size_t>(tilesM) * tilesN);
+    for (int ti = 0; ti < tilesM; ++ti)
+        for (int tj = 0; tj < tilesN; ++tj)
+            tiles.emplace_back(ti, tj);
+    if (order == TileOrder::Morton) {
+        std::sort(tiles.begin(), tiles.end(), [](const auto& a, const auto& b) {
+            return morton_index(a.first, a.second) < morton_index(b.first, b.second);
+        });
+    }
 
-                    int iMax = std::min(ii + blockSize, n);
-                    int jMax = std::min(jj + blockSize, n);
-                    int kMax = std::min(kk + blockSize, n);
+    std::atomic<int> nextTile{0};
+    const int tileCount = static_cast<int>(tiles.size());
+
+    auto worker = [&](int)
+    {
+        for (int t = nextTile.fetch_add(1, std::memory_order_relaxed); t < tileCount;
+             t = nextTile.fetch_add(1, std::memory_order_relaxed)) {
+            int ii = tiles[t].first * blockSize;
+            int jj = tiles[t].second * blockSize;
+            int iMax = std::min(ii + blockSize, M);
+            int jMax = std::min(jj + blockSize, N);
 
-                    for (int i = ii; i < iMax; ++i) {
-                        for (int k = kk; k < kMax; ++k) {
-                            int aVal = A[i*n + k];
-                            for (int j = jj; j < jMax; ++j) {
-                                C[i*n + j] += aVal * B[k*n + j];
-                            }
-                        }
+            for (int kk = 0; kk < K; kk += blockSize) {
+                int kMax = std::min(kk + blockSize, K);
+                for (int i = ii; i < iMax; ++i) {
+                    for (int k = kk; k < kMax; ++k) {
+                        axpy(&C(i, jj), &B(k, jj), static_cast<Acc>(A(i, k)), jMax - jj);
                     }
                 }
             }
         }
     };
 
-    std::vector<std::thread> threads;
-    threads.reserve(threadCount);
-
-    for (int t = 0; t < threadCount; t++) {
-        threads.emplace_back(worker, t);
-    }
-
-    for (auto &th : threads) {
-        th.join();
-    }
+    parallel_for(std::clamp(threadCount, 1, tileCount), worker);
 }
+
+#define CAMM_INSTANTIATE_1D(T, Acc) \
+    template int cache_aware_1D_tile_size<T, Acc>(int, int, int, int); \
+    template void cache_aware_matmul_1D<T, Acc>(MatrixView<const T>, MatrixView<const T>, \
+                                                MatrixView<Acc>, int, TileOrder, int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_1D)
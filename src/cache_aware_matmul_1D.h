@@ -2,11 +2,47 @@
 
 #include <cstddef>
 
-int* allocate_aligned_matrix(std::size_t n);
-void free_aligned_matrix(int* ptr);
+#include "buffer_pool.h"
+#include "matrix.h"
 
-inline int& mat_elem(int* M, int n, int i, int j) {
+// n*n elements of T (int unless stated otherwise), 64-byte aligned and zeroed.
+template <typename T = int>
+T* allocate_aligned_matrix(std::size_t n) {
+    return static_cast<T*>(acquire_buffer(n * n * sizeof(T)));
+}
+
+inline void free_aligned_matrix(void* ptr) {
+    release_buffer(ptr);
+}
+
+template <typename T>
+inline T& mat_elem(T* M, int n, int i, int j) {
     return M[i*n + j];
 }
 
-void cache_aware_matmul_1D(const int* A, const int* B, int* C, int n, int threadCount);
+// Order in which the tiles of C are handed out to the workers.
+enum class TileOrder {
+    RowMajor,   // tile rows left to right, top to bottom
+    Morton      // Z-order: consecutive tiles share rows of A and columns of B
+};
+
+// Tile edge cache_aware_matmul_1D uses for an M x K x N product: tileSize,
+// or the tuned edge when it is <= 0, rounded up to a multiple of 16.
+template <typename T, typename Acc>
+int cache_aware_1D_tile_size(int M, int N, int K, int tileSize = 0);
+
+// C is cut into a 2D grid of tiles (64x64 unless --tune picked another edge)
+// that threadCount workers claim one at a time from an atomic counter, so load
+// balances for any n and thread count. threadCount <= 0 takes the tuned count,
+// or one per pool worker; tileSize <= 0 takes the tuned edge.
+template <typename T, typename Acc>
+void cache_aware_matmul_1D(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                           int threadCount, TileOrder order = TileOrder::Morton, int tileSize = 0);
+
+// Square n x n buffers from allocate_aligned_matrix.
+template <typename T, typename Acc>
+void cache_aware_matmul_1D(const T* A, const T* B, Acc* C, int n, int threadCount,
+                           TileOrder order = TileOrder::Morton) {
+    cache_aware_matmul_1D<T, Acc>(MatrixView<const T>(A, n, n, n), MatrixView<const T>(B, n, n, n),
+                                  MatrixView<Acc>(C, n, n, n), threadCount, order);
+}
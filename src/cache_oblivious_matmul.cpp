@@ -1,45 +1,122 @@
 #include "cache_oblivious_matmul.h"
+#include "simd_kernels.h"
+#include "matmul_types.h"
+#include "task_scheduler.h"
+#include "tuning.h"
 #include <algorithm>
 
-// Helper recursive function to multiply sub-matrices.
-// (Parameters: starting indices and size for each submatrix.)
-static void matmul_recursive(const std::vector<std::vector<int>>& A,
-                             const std::vector<std::vector<int>>& B,
-                             std::vector<std::vector<int>>& C,
-                             int aRow, int aCol, int bRow, int bCol,
-                             int cRow, int cCol, int size) {
+// Halfway point of a column range, rounded up to a whole cache line of Acc so
+// the base-case rows stay vector-aligned instead of ending in odd-width tails.
+template <typename Acc>
+static int split_point(int n) {
+    constexpr int line = static_cast<int>(64 / sizeof(Acc));
+    int h = (n / 2 + line - 1) / line * line;
+    return (h > 0 && h < n) ? h : n / 2;
+}
+
+template <typename T, typename Acc>
+static int resolve_cutoff(int cutoff, int M, int N, int K) {
+    if (cutoff <= 0)
+        cutoff = tuned_value(TuneKey::ObliviousCutoff, dtype_of<T, Acc>(), M, N, K, 64);
+    return std::max(cutoff, 1);
+}
+
+// Helper recursive function to multiply sub-matrices (Frigo et al.):
+// C(MxN) += A(MxK) * B(KxN), halving whichever of M, N or K is largest.
+// Halves are m/2 and m - m/2, so odd and rectangular shapes are covered exactly.
+template <typename T, typename Acc>
+static void matmul_recursive(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                             int cutoff) {
+    int M = C.rows(), N = C.cols(), K = A.cols();
+
     // Base case: use naive multiplication for small blocks.
-    if (size <= 64) {  // cutoff threshold can be tuned
-        for (int i = 0; i < size; ++i)
-            for (int k = 0; k < size; ++k)
-                for (int j = 0; j < size; ++j)
-                    C[cRow + i][cCol + j] += A[aRow + i][aCol + k] * B[bRow + k][bCol + j];
+    if (std::max({M, N, K}) <= cutoff) {
+        const auto axpy = simd_kernels<T, Acc>().axpy;
+        for (int i = 0; i < M; ++i)
+            for (int k = 0; k < K; ++k)
+                axpy(C.row(i), B.row(k), static_cast<Acc>(A(i, k)), N);
         return;
     }
 
-    int newSize = size / 2;
+    if (M >= N && M >= K) {
+        // Split rows: [C1; C2] = [A1; A2] * B
+        int h = M / 2;
+        matmul_recursive(A.block(0, 0, h, K),     B, C.block(0, 0, h, N), cutoff);
+        matmul_recursive(A.block(h, 0, M - h, K), B, C.block(h, 0, M - h, N), cutoff);
+    } else if (N >= K) {
+        // Split columns: [C1 C2] = A * [B1 B2]
+        int h = split_point<Acc>(N);
+        matmul_recursive(A, B.block(0, 0, K, h),     C.block(0, 0, M, h), cutoff);
+        matmul_recursive(A, B.block(0, h, K, N - h), C.block(0, h, M, N - h), cutoff);
+    } else {
+        // Split the inner dimension: C += A1*B1, then C += A2*B2
+        int h = K / 2;
+        matmul_recursive(A.block(0, 0, M, h),     B.block(0, 0, h, N),     C, cutoff);
+        matmul_recursive(A.block(0, h, M, K - h), B.block(h, 0, K - h, N), C, cutoff);
+    }
+}
 
-    // Multiply sub-quadrants recursively.
-    // C11 = A11*B11 + A12*B21
-    matmul_recursive(A, B, C, aRow, aCol, bRow, bCol, cRow, cCol, newSize);
-    matmul_recursive(A, B, C, aRow, aCol + newSize, bRow + newSize, bCol, cRow, cCol, newSize);
+template <typename T, typename Acc>
+void cache_oblivious_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                            int cutoff) {
+    if (C.empty() || A.cols() <= 0)
+        return;
+    if (try_fixed_matmul<T, Acc>(C.rows(), C.cols(), A.cols(), A.data(), A.ld(), B.data(), B.ld(),
+                                 C.data(), C.ld()))
+        return;
+    matmul_recursive(A, B, C, resolve_cutoff<T, Acc>(cutoff, C.rows(), C.cols(), A.cols()));
+}
 
-    // C12 = A11*B12 + A12*B22
-    matmul_recursive(A, B, C, aRow, aCol, bRow, bCol + newSize, cRow, cCol + newSize, newSize);
-    matmul_recursive(A, B, C, aRow, aCol + newSize, bRow + newSize, bCol + newSize, cRow, cCol + newSize, newSize);
+// Fork-join version of matmul_recursive. Halves of an M or N split write
+// disjoint parts of C, so one is spawned as a task while this thread runs the
+// other; the two halves of a K split update the same C and stay sequential.
+// Below the grain volume the serial recursion takes over.
+template <typename T, typename Acc>
+static void matmul_recursive_parallel(MatrixView<const T> A, MatrixView<const T> B,
+                                      MatrixView<Acc> C, double grainVolume, int cutoff) {
+    int M = C.rows(), N = C.cols(), K = A.cols();
 
-    // C21 = A21*B11 + A22*B21
-    matmul_recursive(A, B, C, aRow + newSize, aCol, bRow, bCol, cRow + newSize, cCol, newSize);
-    matmul_recursive(A, B, C, aRow + newSize, aCol + newSize, bRow + newSize, bCol, cRow + newSize, cCol, newSize);
+    if (static_cast<double>(M) * N * K <= grainVolume) {
+        matmul_recursive(A, B, C, cutoff);
+        return;
+    }
 
-    // C22 = A21*B12 + A22*B22
-    matmul_recursive(A, B, C, aRow + newSize, aCol, bRow, bCol + newSize, cRow + newSize, cCol + newSize, newSize);
-    matmul_recursive(A, B, C, aRow + newSize, aCol + newSize, bRow + newSize, bCol + newSize, cRow + newSize, cCol + newSize, newSize);
+    if (M >= N && M >= K) {
+        int h = M / 2;
+        TaskGroup group;
+        group.spawn([=] { matmul_recursive_parallel(A.block(0, 0, h, K), B, C.block(0, 0, h, N), grainVolume, cutoff); });
+        matmul_recursive_parallel(A.block(h, 0, M - h, K), B, C.block(h, 0, M - h, N), grainVolume, cutoff);
+        group.wait();
+    } else if (N >= K) {
+        int h = split_point<Acc>(N);
+        TaskGroup group;
+        group.spawn([=] { matmul_recursive_parallel(A, B.block(0, 0, K, h), C.block(0, 0, M, h), grainVolume, cutoff); });
+        matmul_recursive_parallel(A, B.block(0, h, K, N - h), C.block(0, h, M, N - h), grainVolume, cutoff);
+        group.wait();
+    } else {
+        int h = K / 2;
+        matmul_recursive_parallel(A.block(0, 0, M, h),     B.block(0, 0, h, N),     C, grainVolume, cutoff);
+        matmul_recursive_parallel(A.block(0, h, M, K - h), B.block(h, 0, K - h, N), C, grainVolume, cutoff);
+    }
 }
 
-void cache_oblivious_matmul(const std::vector<std::vector<int>>& A,
-                            const std::vector<std::vector<int>>& B,
-                            std::vector<std::vector<int>>& C) {
-    int n = A.size();
-    matmul_recursive(A, B, C, 0, 0, 0, 0, 0, 0, n);
+template <typename T, typename Acc>
+void cache_oblivious_matmul_parallel(MatrixView<const T> A, MatrixView<const T> B,
+                                     MatrixView<Acc> C, int grainSize, int cutoff) {
+    if (C.empty() || A.cols() <= 0)
+        return;
+    if (try_fixed_matmul<T, Acc>(C.rows(), C.cols(), A.cols(), A.data(), A.ld(), B.data(), B.ld(),
+                                 C.data(), C.ld()))
+        return;
+    double grain = std::max(grainSize, 1);
+    cutoff = resolve_cutoff<T, Acc>(cutoff, C.rows(), C.cols(), A.cols());
+    matmul_recursive_parallel(A, B, C, grain * grain * grain, cutoff);
 }
+
+#define CAMM_INSTANTIATE_CACHE_OBLIVIOUS(T, Acc)                                                \
+    template void cache_oblivious_matmul<T, Acc>(MatrixView<const T>, MatrixView<const T>,      \
+                                                 MatrixView<Acc>, int);                         \
+    template void cache_oblivious_matmul_parallel<T, Acc>(MatrixView<const T>,                  \
+                                                          MatrixView<const T>,                  \
+                                                          MatrixView<Acc>, int, int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_CACHE_OBLIVIOUS)
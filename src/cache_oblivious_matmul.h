@@ -1,10 +1,18 @@
 #ifndef CACHE_OBLIVIOUS_MATMUL_H
 #define CACHE_OBLIVIOUS_MATMUL_H
 
-#include <vector>
+#include "matrix.h"
 
-void cache_oblivious_matmul(const std::vector<std::vector<int>>& A,
-                            const std::vector<std::vector<int>>& B,
-                            std::vector<std::vector<int>>& C);
+// Recursion stops at blocks whose largest edge is at most `cutoff`; 0 takes
+// the tuned value for this type and shape (64 when untuned).
+template <typename T, typename Acc>
+void cache_oblivious_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                            int cutoff = 0);
+
+// Same recursion run as fork-join tasks on TaskScheduler::instance(). Subproblems
+// with at most grainSize^3 multiply-adds run serially.
+template <typename T, typename Acc>
+void cache_oblivious_matmul_parallel(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                                     int grainSize = 128, int cutoff = 0);
 
 #endif // CACHE_OBLIVIOUS_MATMUL_H
@@ -1,7 +1,29 @@
 #include "cache_utils.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector> 
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define CAMM_X86 1
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+#ifdef __linux__
+    #include <sched.h>
+#endif
+
 #ifdef _WIN32
     #ifndef _WIN32_WINNT
     #define _WIN32_WINNT 0x0600
@@ -24,14 +46,23 @@ bool get_sysctl_value(const char* name, size_t &valueOut) {
     #ifdef _SC_LEVEL1_DCACHE_SIZE
         #define HAS_SC_LEVEL1_DCACHE_SIZE
     #endif
+    #ifdef _SC_LEVEL2_CACHE_SIZE
+        #define HAS_SC_LEVEL2_CACHE_SIZE
+    #endif
+    #ifdef _SC_LEVEL3_CACHE_SIZE
+        #define HAS_SC_LEVEL3_CACHE_SIZE
+    #endif
 #endif
 
 /**
  * Retrieve cache line size in bytes.
+ * - The L1 data cache of system_topology() if it was discovered.
  * - On Linux/macOS, uses sysconf, else fallback = 64.
  * - On Windows, uses GetLogicalProcessorInformation, else fallback = 64.
  */
 size_t get_cache_line_size() {
+    if (const CacheInfo* l1 = system_topology().data_cache(1))
+        return l1->line_size;
 #ifdef _WIN32
     DWORD bufferSize = 0;
     // First call to get the size of the buffer.
@@ -70,10 +101,13 @@ size_t get_cache_line_size() {
 
 /**
  * Retrieve L1 cache size in bytes.
+ * - The L1 data cache of system_topology() if it was discovered.
  * - On Linux/macOS, uses sysconf, else fallback = 32 KB.
  * - On Windows, uses GetLogicalProcessorInformation, else fallback = 32 KB.
  */
 size_t get_l1_cache_size() {
+    if (const CacheInfo* l1 = system_topology().data_cache(1))
+        return l1->size;
 #ifdef _WIN32
     DWORD bufferSize = 0;
     GetLogicalProcessorInformation(nullptr, &bufferSize);
@@ -110,3 +144,380 @@ size_t get_l1_cache_size() {
     return 32 * 1024;
 #endif
 }
+
+#ifdef _WIN32
+// Shared lookup for the unified cache levels on Windows.
+static size_t get_windows_cache_size(int level) {
+    DWORD bufferSize = 0;
+    GetLogicalProcessorInformation(nullptr, &bufferSize);
+    if (GetLastError() == ERROR_INSUFFICIENT_BUFFER) {
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> buffer(
+            bufferSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (GetLogicalProcessorInformation(buffer.data(), &bufferSize)) {
+            for (auto &info : buffer) {
+                if (info.Relationship == RelationCache && info.Cache.Level == level) {
+                    return info.Cache.Size;
+                }
+            }
+        }
+    }
+    return 0;
+}
+#endif
+
+/**
+ * Retrieve L2 cache size in bytes.
+ * - Same sources as get_l1_cache_size(), fallback = 256 KB.
+ */
+size_t get_l2_cache_size() {
+    if (const CacheInfo* l2 = system_topology().data_cache(2))
+        return l2->size;
+#ifdef _WIN32
+    size_t l2Size = get_windows_cache_size(2);
+    return l2Size > 0 ? l2Size : 256 * 1024;
+#elif __APPLE__
+    size_t l2Size = 0;
+    if (get_sysctl_value("hw.l2cachesize", l2Size) && l2Size > 0) {
+        return l2Size;
+    }
+    return 256 * 1024;
+#else
+    #ifdef HAS_SC_LEVEL2_CACHE_SIZE
+        long cacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (cacheSize > 0) {
+            return static_cast<size_t>(cacheSize);
+        }
+    #endif
+    return 256 * 1024;
+#endif
+}
+
+/**
+ * Retrieve L3 cache size in bytes.
+ * - Same sources as get_l1_cache_size(), fallback = 8 MB.
+ *   Apple silicon has no L3, so the L2 size is returned there instead.
+ */
+size_t get_l3_cache_size() {
+    if (const CacheInfo* l3 = system_topology().data_cache(3))
+        return l3->size;
+#ifdef _WIN32
+    size_t l3Size = get_windows_cache_size(3);
+    return l3Size > 0 ? l3Size : 8 * 1024 * 1024;
+#elif __APPLE__
+    size_t l3Size = 0;
+    if (get_sysctl_value("hw.l3cachesize", l3Size) && l3Size > 0) {
+        return l3Size;
+    }
+    return get_l2_cache_size();
+#else
+    #ifdef HAS_SC_LEVEL3_CACHE_SIZE
+        long cacheSize = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if (cacheSize > 0) {
+            return static_cast<size_t>(cacheSize);
+        }
+    #endif
+    return 8 * 1024 * 1024;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Topology discovery
+//------------------------------------------------------------------------------
+
+const CacheInfo* SystemTopology::data_cache(int level) const
+{
+    for (const CacheInfo& cache : caches)
+        if (cache.level == level && cache.type != CacheType::Instruction)
+            return &cache;
+    return nullptr;
+}
+
+int SystemTopology::last_level() const
+{
+    int last = 0;
+    for (const CacheInfo& cache : caches)
+        if (cache.type != CacheType::Instruction)
+            last = std::max(last, cache.level);
+    return last;
+}
+
+int SystemTopology::packages() const
+{
+    std::set<int> ids;
+    for (const CpuInfo& info : cpus)
+        ids.insert(info.package);
+    return static_cast<int>(ids.size());
+}
+
+int SystemTopology::physical_cores() const
+{
+    std::set<std::pair<int, int>> ids;
+    for (const CpuInfo& info : cpus)
+        ids.insert({ info.package, info.core });
+    return static_cast<int>(ids.size());
+}
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+static std::vector<int> parse_cpu_list(const std::string& text)
+{
+    std::vector<int> cpus;
+    std::stringstream in(text);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        if (range.empty())
+            continue;
+        std::size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+// Keeps only the CPUs present in `allowed` (both sorted).
+static std::vector<int> restrict_to(const std::vector<int>& cpus, const std::vector<int>& allowed)
+{
+    std::vector<int> out;
+    std::set_intersection(cpus.begin(), cpus.end(), allowed.begin(), allowed.end(),
+                          std::back_inserter(out));
+    return out;
+}
+
+#ifdef __linux__
+static bool read_sys(const std::string& path, std::string& out)
+{
+    std::ifstream in(path);
+    return static_cast<bool>(std::getline(in, out));
+}
+
+// Cache sizes in sysfs look like "48K" or "32768K" (occasionally "2M").
+static size_t parse_cache_size(const std::string& text)
+{
+    size_t value = std::stoul(text);
+    char unit = text.empty() ? ' ' : text.back();
+    if (unit == 'K') return value << 10;
+    if (unit == 'M') return value << 20;
+    if (unit == 'G') return value << 30;
+    return value;
+}
+
+/**
+ * Every cpuN/cache/indexM of one CPU; empty if sysfs has no cache directory.
+ */
+static std::vector<CacheInfo> read_sys_caches(int cpu, const std::vector<int>& allowed)
+{
+    std::vector<CacheInfo> caches;
+    const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/index";
+    for (int index = 0;; ++index) {
+        const std::string dir = base + std::to_string(index) + "/";
+        std::string level, type, size, line, ways, sets, shared;
+        if (!read_sys(dir + "level", level) || !read_sys(dir + "type", type) ||
+            !read_sys(dir + "size", size))
+            break;
+
+        CacheInfo info;
+        info.level = std::stoi(level);
+        info.type = type == "Data" ? CacheType::Data
+                  : type == "Instruction" ? CacheType::Instruction : CacheType::Unified;
+        info.size = parse_cache_size(size);
+        info.line_size = read_sys(dir + "coherency_line_size", line) ? std::stoul(line) : 64;
+        info.ways = read_sys(dir + "ways_of_associativity", ways) ? std::stoi(ways) : 0;
+        info.sets = read_sys(dir + "number_of_sets", sets) ? std::stoi(sets) : 0;
+        info.shared_cpus = read_sys(dir + "shared_cpu_list", shared)
+                         ? restrict_to(parse_cpu_list(shared), allowed) : std::vector<int>{ cpu };
+        caches.push_back(info);
+    }
+    return caches;
+}
+
+/**
+ * CPUs from sched_getaffinity with their ids from cpuN/topology, and caches
+ * from the first of them. cache_groups collects every allowed CPU's
+ * shared_cpu_list per level, so asymmetric layouts are covered too.
+ */
+static void discover_sysfs(SystemTopology& topo)
+{
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) != 0)
+        return;
+
+    std::vector<int> allowed;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        if (CPU_ISSET(cpu, &mask))
+            allowed.push_back(cpu);
+
+    for (int cpu : allowed) {
+        const std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+        std::string package, core;
+        CpuInfo info = { cpu, 0, cpu };
+        if (read_sys(dir + "physical_package_id", package) && read_sys(dir + "core_id", core)) {
+            info.package = std::stoi(package);
+            info.core = std::stoi(core);
+        }
+        topo.cpus.push_back(info);
+    }
+    if (allowed.empty())
+        return;
+
+    topo.caches = read_sys_caches(allowed.front(), allowed);
+
+    std::vector<std::set<std::vector<int>>> groups;
+    for (int cpu : allowed) {
+        for (const CacheInfo& cache : read_sys_caches(cpu, allowed)) {
+            if (cache.type == CacheType::Instruction)
+                continue;
+            if (static_cast<int>(groups.size()) <= cache.level)
+                groups.resize(cache.level + 1);
+            groups[cache.level].insert(cache.shared_cpus);
+        }
+    }
+    topo.cache_groups.resize(groups.size());
+    for (std::size_t level = 0; level < groups.size(); ++level)
+        topo.cache_groups[level].assign(groups[level].begin(), groups[level].end());
+}
+#endif
+
+#ifdef CAMM_X86
+static void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned>(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/**
+ * Deterministic cache parameters: leaf 4 on Intel, 0x8000001D on AMD/Hygon
+ * (same register layout). The sharing count is the number of logical
+ * processor ids that share the cache, so CPUs are grouped by consecutive ids.
+ */
+static void discover_cpuid(SystemTopology& topo)
+{
+    unsigned r[4];
+    cpuid(0, 0, r);
+    const bool amd = (r[1] == 0x68747541 /* "Auth" */ || r[1] == 0x6f677948 /* "Hygo" */);
+    unsigned leaf = 4;
+    if (amd) {
+        cpuid(0x80000000u, 0, r);
+        if (r[0] < 0x8000001Du)
+            return;
+        leaf = 0x8000001Du;
+    } else if (r[0] < 4) {
+        return;
+    }
+
+    std::vector<int> all;
+    for (const CpuInfo& info : topo.cpus)
+        all.push_back(info.cpu);
+
+    for (unsigned sub = 0; sub < 16; ++sub) {
+        cpuid(leaf, sub, r);
+        unsigned kind = r[0] & 0x1F;
+        if (kind == 0)
+            break;
+
+        CacheInfo info;
+        info.level = static_cast<int>((r[0] >> 5) & 0x7);
+        info.type = kind == 1 ? CacheType::Data : kind == 2 ? CacheType::Instruction : CacheType::Unified;
+        info.ways = static_cast<int>((r[1] >> 22) + 1);
+        int partitions = static_cast<int>(((r[1] >> 12) & 0x3FF) + 1);
+        info.line_size = (r[1] & 0xFFF) + 1;
+        info.sets = static_cast<int>(r[2] + 1);
+        info.size = static_cast<size_t>(info.ways) * partitions * info.line_size * info.sets;
+
+        std::size_t sharing = std::min<std::size_t>(((r[0] >> 14) & 0xFFF) + 1, all.size());
+        info.shared_cpus.assign(all.begin(), all.begin() + std::max<std::size_t>(sharing, 1));
+        topo.caches.push_back(info);
+
+        if (info.type == CacheType::Instruction)
+            continue;
+        if (static_cast<int>(topo.cache_groups.size()) <= info.level)
+            topo.cache_groups.resize(info.level + 1);
+        auto& groups = topo.cache_groups[info.level];
+        groups.clear();
+        for (std::size_t i = 0; i < all.size(); i += std::max<std::size_t>(sharing, 1))
+            groups.emplace_back(all.begin() + i,
+                                all.begin() + std::min(all.size(), i + std::max<std::size_t>(sharing, 1)));
+    }
+}
+#endif
+
+static SystemTopology discover_topology()
+{
+    SystemTopology topo;
+#ifdef __linux__
+    discover_sysfs(topo);
+#endif
+
+    if (topo.cpus.empty()) {
+        int count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < count; ++cpu)
+            topo.cpus.push_back({ cpu, 0, cpu });
+    }
+
+#ifdef CAMM_X86
+    if (topo.caches.empty())
+        discover_cpuid(topo);
+#endif
+
+    std::stable_sort(topo.caches.begin(), topo.caches.end(), [](const CacheInfo& a, const CacheInfo& b) {
+        if (a.level != b.level)
+            return a.level < b.level;
+        return a.type != CacheType::Instruction && b.type == CacheType::Instruction;
+    });
+    return topo;
+}
+
+const SystemTopology& system_topology()
+{
+    static const SystemTopology topology = discover_topology();
+    return topology;
+}
+
+/**
+ * Brand string from CPUID 0x80000002..4 where there is one, so the same
+ * machine gets the same key on every OS.
+ */
+std::string cpu_model_name()
+{
+    std::string name;
+#ifdef CAMM_X86
+    unsigned r[4];
+    cpuid(0x80000000u, 0, r);
+    if (r[0] >= 0x80000004u) {
+        char brand[49] = {};
+        for (unsigned leaf = 0; leaf < 3; ++leaf) {
+            cpuid(0x80000002u + leaf, 0, r);
+            std::memcpy(brand + 16 * leaf, r, 16);
+        }
+        name = brand;
+    }
+#endif
+
+#ifdef __linux__
+    if (name.empty()) {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (name.empty() && std::getline(cpuinfo, line)) {
+            if (line.rfind("model name", 0) == 0 || line.rfind("Model", 0) == 0)
+                name = line.substr(line.find(':') + 1);
+        }
+    }
+#elif __APPLE__
+    if (name.empty()) {
+        char brand[256] = {};
+        size_t len = sizeof(brand);
+        if (sysctlbyname("machdep.cpu.brand_string", brand, &len, NULL, 0) == 0)
+            name = brand;
+    }
+#endif
+
+    std::size_t first = name.find_first_not_of(" \t");
+    std::size_t last = name.find_last_not_of(" \t");
+    return first == std::string::npos ? "unknown" : name.substr(first, last - first + 1);
+}
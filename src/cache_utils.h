@@ -2,9 +2,65 @@
 #define CACHE_UTILS_H
 
 #include <cstddef> // size_t
+#include <string>
+#include <vector>
 
 // Attempt to retrieve a best-guess for L1 data cache size and cache line size.
+// These prefer system_topology() and only fall back to OS queries / constants.
 size_t get_cache_line_size();
 size_t get_l1_cache_size();
 
+// Unified L2 / L3 cache sizes in bytes, used to size the packed GEMM panels.
+size_t get_l2_cache_size();
+size_t get_l3_cache_size();
+
+enum class CacheType {
+    Data,
+    Instruction,
+    Unified
+};
+
+// One cache level as seen from the first CPU this process may run on.
+struct CacheInfo {
+    int level;                     // 1, 2, 3, ...
+    CacheType type;
+    size_t size;                   // bytes
+    size_t line_size;              // bytes
+    int ways;                      // associativity (0 if unknown; fully associative reports sets = 1)
+    int sets;
+    std::vector<int> shared_cpus;  // logical CPUs sharing this instance (just the CPU itself if unknown)
+};
+
+// One logical CPU with its socket and physical core.
+struct CpuInfo {
+    int cpu;
+    int package;    // socket
+    int core;       // physical core id within the package
+};
+
+// Caches and CPUs of the machine, restricted to the CPUs this process may run on.
+struct SystemTopology {
+    std::vector<CacheInfo> caches;  // ordered by level, L1 instruction after L1 data
+    std::vector<CpuInfo> cpus;
+    // cache_groups[level]: the CPUs grouped by which instance of that data /
+    // unified cache they share, e.g. one group per L3 slice or CCX.
+    std::vector<std::vector<std::vector<int>>> cache_groups;
+
+    // Data or unified cache at `level`, or nullptr.
+    const CacheInfo* data_cache(int level) const;
+    // Highest data/unified level present (0 if nothing was found).
+    int last_level() const;
+    int packages() const;
+    int physical_cores() const;
+};
+
+// Discovered once, from /sys/devices/system/cpu on Linux, else CPUID leaf 4
+// (0x8000001D on AMD) on x86. Anything not found is left out; the size
+// getters above then fall back to the OS queries and their constants.
+const SystemTopology& system_topology();
+
+// CPU model as a human-readable string (CPUID brand string on x86, else
+// /proc/cpuinfo or sysctl), "unknown" if none is available. Keys tuning files.
+std::string cpu_model_name();
+
 #endif // CACHE_UTILS_H
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "camatmul.h"
+#include "gemm.h"
+
+#include <algorithm>
+#include <new>
+
+namespace {
+
+// Checks the arguments the way BLAS xerbla does, then runs gemm(). No C++
+// exception crosses the C boundary.
+template <typename T, typename Acc>
+camm_status gemm_c(camm_transpose transA, camm_transpose transB, int M, int N, int K, Acc alpha,
+                   const T* A, int lda, const T* B, int ldb, Acc beta, Acc* C, int ldc)
+{
+    auto valid = [](camm_transpose t) { return t == CAMM_NO_TRANS || t == CAMM_TRANS; };
+    if (!valid(transA) || !valid(transB) || M < 0 || N < 0 || K < 0)
+        return CAMM_INVALID_ARGUMENT;
+    // Row-major: the leading dimension is at least the stored width.
+    if (lda < std::max(1, transA == CAMM_TRANS ? M : K) || ldb < std::max(1, transB == CAMM_TRANS ? K : N)
+        || ldc < std::max(1, N))
+        return CAMM_INVALID_ARGUMENT;
+    if (M == 0 || N == 0)
+        return CAMM_OK;
+    if (!C || (K > 0 && alpha != Acc(0) && (!A || !B)))
+        return CAMM_INVALID_ARGUMENT;
+
+    try {
+        gemm<T, Acc>(transA == CAMM_TRANS ? Trans::Yes : Trans::No,
+                     transB == CAMM_TRANS ? Trans::Yes : Trans::No,
+                     M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    } catch (const std::bad_alloc&) {
+        return CAMM_OUT_OF_MEMORY;
+    } catch (...) {
+        return CAMM_INTERNAL_ERROR;
+    }
+    return CAMM_OK;
+}
+
+} // namespace
+
+extern "C" {
+
+int camm_version(void)
+{
+    return CAMM_VERSION;
+}
+
+const char* camm_status_string(camm_status status)
+{
+    switch (status) {
+        case CAMM_OK:               return "success";
+        case CAMM_INVALID_ARGUMENT: return "invalid argument";
+        case CAMM_OUT_OF_MEMORY:    return "out of memory";
+        case CAMM_INTERNAL_ERROR:   return "internal error";
+    }
+    return "unknown status";
+}
+
+camm_status camm_gemm_f32(camm_transpose transA, camm_transpose transB, int M, int N, int K, float alpha,
+                          const float* A, int lda, const float* B, int ldb, float beta, float* C, int ldc)
+{
+    return gemm_c<float, float>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+camm_status camm_gemm_f64(camm_transpose transA, camm_transpose transB, int M, int N, int K, double alpha,
+                          const double* A, int lda, const double* B, int ldb, double beta, double* C, int ldc)
+{
+    return gemm_c<double, double>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+camm_status camm_gemm_i8(camm_transpose transA, camm_transpose transB, int M, int N, int K, int32_t alpha,
+                         const int8_t* A, int lda, const int8_t* B, int ldb, int32_t beta, int32_t* C, int ldc)
+{
+    return gemm_c<int8_t, int32_t>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+camm_status camm_gemm_i16(camm_transpose transA, camm_transpose transB, int M, int N, int K, int32_t alpha,
+                          const int16_t* A, int lda, const int16_t* B, int ldb, int32_t beta, int32_t* C, int ldc)
+{
+    return gemm_c<int16_t, int32_t>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+camm_status camm_gemm_i32(camm_transpose transA, camm_transpose transB, int M, int N, int K, int32_t alpha,
+                          const int32_t* A, int lda, const int32_t* B, int ldb, int32_t beta, int32_t* C, int ldc)
+{
+    return gemm_c<int32_t, int32_t>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+camm_status camm_gemm_i64(camm_transpose transA, camm_transpose transB, int M, int N, int K, int64_t alpha,
+                          const int32_t* A, int lda, const int32_t* B, int ldb, int64_t beta, int64_t* C, int ldc)
+{
+    return gemm_c<int32_t, int64_t>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+} // extern "C"
@@ -0,0 +1,78 @@
+#ifndef FIXED_MATMUL_H
+#define FIXED_MATMUL_H
+
+#include <array>
+
+// CAMM_KEEP_ROLLED keeps a constant-trip loop rolled so the vectorizer sees
+// it; GCC otherwise unrolls it completely first and falls back to scalar code.
+// CAMM_UNROLL_DEPTH unrolls the depth loop of the fixed-size kernels eight
+// deep; unrolling 32 or 64 steps completely spills the accumulators.
+#if defined(__GNUC__)
+    #define CAMM_KEEP_ROLLED  _Pragma("GCC unroll 1")
+    #define CAMM_UNROLL_DEPTH _Pragma("GCC unroll 8")
+#else
+    #define CAMM_KEEP_ROLLED
+    #define CAMM_UNROLL_DEPTH
+#endif
+
+// Largest divisor of n that is <= limit: the register tile edge along n.
+constexpr int fixed_tile_edge(int n, int limit)
+{
+    for (int d = n < limit ? n : limit; d > 1; --d)
+        if (n % d == 0)
+            return d;
+    return 1;
+}
+
+/**
+ * C(MxK x KxN) += A * B for sizes known at compile time, row-major with
+ * leading dimensions. C is computed in R x W register tiles (R up to 4 rows,
+ * W up to RowBytes of Acc, both dividing the shape), each accumulated over
+ * the whole depth: R * W / vector width independent accumulators and one
+ * broadcast of A per row and step. RowBytes is two vectors of the target ISA
+ * (one on AVX-512), so the tile stays within the register file.
+ *
+ * Also a constexpr function. The runtime entry points reach it through
+ * try_fixed_matmul (simd_kernels.h), which has a copy per ISA.
+ */
+template <int M, int K, int N, typename T, typename Acc = T, int RowBytes = 64>
+constexpr void matmul(const T* A, int lda, const T* B, int ldb, Acc* C, int ldc)
+{
+    static_assert(M > 0 && K > 0 && N > 0, "fixed matmul needs a non-empty shape");
+    constexpr int R = fixed_tile_edge(M, 4);
+    constexpr int W = fixed_tile_edge(N, RowBytes / int(sizeof(Acc)));
+
+    for (int i0 = 0; i0 < M; i0 += R) {
+        for (int j0 = 0; j0 < N; j0 += W) {
+            Acc acc[R][W] = {};
+            CAMM_UNROLL_DEPTH
+            for (int k = 0; k < K; ++k) {
+                const T* b = B + k * ldb + j0;
+                for (int r = 0; r < R; ++r) {
+                    Acc a = static_cast<Acc>(A[(i0 + r) * lda + k]);
+                    CAMM_KEEP_ROLLED
+                    for (int j = 0; j < W; ++j)
+                        acc[r][j] += a * static_cast<Acc>(b[j]);
+                }
+            }
+            for (int r = 0; r < R; ++r) {
+                Acc* c = C + (i0 + r) * ldc + j0;
+                CAMM_KEEP_ROLLED
+                for (int j = 0; j < W; ++j)
+                    c[j] += acc[r][j];
+            }
+        }
+    }
+}
+
+// Value form: the M x N product of two dense row-major arrays.
+//   constexpr auto C = matmul<2, 2, 2>(std::array<int, 4>{1, 2, 3, 4}, identity);
+template <int M, int K, int N, typename T, typename Acc = T>
+constexpr std::array<Acc, M * N> matmul(const std::array<T, M * K>& A, const std::array<T, K * N>& B)
+{
+    std::array<Acc, M * N> C{};
+    matmul<M, K, N, T, Acc>(A.data(), K, B.data(), N, C.data(), N);
+    return C;
+}
+
+#endif // FIXED_MATMUL_H
@@ -0,0 +1,126 @@
+#include "gemm.h"
+#include "cache_aware_matmul.h"
+#include "cache_aware_matmul_1D.h"
+#include "cache_oblivious_matmul.h"
+#include "cache_utils.h"
+#include "matmul_types.h"
+#include "matrix.h"
+#include "morton_matrix.h"
+#include "naive_matmul.h"
+#include "packed_matmul.h"
+#include "simd_kernels.h"
+#include "strassen_matmul.h"
+
+#include <algorithm>
+
+namespace {
+
+// op(X) as a rows x cols view: X itself, or a transposed copy in `copy`.
+template <typename T>
+MatrixView<const T> operand(Trans trans, const T* X, int ld, int rows, int cols, Matrix<T>& copy)
+{
+    if (trans == Trans::No)
+        return MatrixView<const T>(X, rows, cols, ld);
+    copy = Matrix<T>(rows, cols, typename Matrix<T>::Uninitialized{});
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            copy(i, j) = X[static_cast<std::ptrdiff_t>(j) * ld + i];
+    return copy.view();
+}
+
+// C += A * B with one of the accumulate-only algorithms.
+template <typename T, typename Acc>
+void accumulate(GemmAlgo algo, MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                int threadCount)
+{
+    switch (algo) {
+    case GemmAlgo::Naive:
+        naive_matmul<T, Acc>(A, B, C);
+        break;
+    case GemmAlgo::CacheAware:
+        cache_aware_matmul<T, Acc>(A, B, C, static_cast<int>(get_cache_line_size()),
+                                   static_cast<int>(get_l1_cache_size()));
+        break;
+    case GemmAlgo::CacheOblivious:
+        cache_oblivious_matmul<T, Acc>(A, B, C);
+        break;
+    case GemmAlgo::ObliviousParallel:
+        cache_oblivious_matmul_parallel<T, Acc>(A, B, C);
+        break;
+    case GemmAlgo::Morton: {
+        int grid = morton_grid_for(std::max({ A.rows(), A.cols(), B.cols() }));
+        MortonMatrix<T>   Am(A.rows(), A.cols(), grid);
+        MortonMatrix<T>   Bm(B.rows(), B.cols(), grid);
+        MortonMatrix<Acc> Cm(C.rows(), C.cols(), grid);
+        to_morton<T>(A, Am);
+        to_morton<T>(B, Bm);
+        to_morton<Acc>(C, Cm);
+        cache_oblivious_matmul_morton<T, Acc>(Am, Bm, Cm);
+        from_morton<Acc>(Cm, C);
+        break;
+    }
+    case GemmAlgo::OneD:
+        cache_aware_matmul_1D<T, Acc>(A, B, C, threadCount);
+        break;
+    case GemmAlgo::Strassen:
+        strassen_matmul<T, Acc>(A, B, C, threadCount);
+        break;
+    case GemmAlgo::Auto:
+    case GemmAlgo::Packed:
+        packed_matmul<T, Acc>(A, B, C, threadCount);
+        break;
+    }
+}
+
+} // namespace
+
+template <typename T, typename Acc>
+void gemm(Trans transA, Trans transB, int M, int N, int K, Acc alpha,
+          const T* A, int lda,
+          const T* B, int ldb,
+          Acc beta, Acc* C, int ldc,
+          GemmAlgo algo, int threadCount)
+{
+    if (M <= 0 || N <= 0)
+        return;
+
+    if (algo == GemmAlgo::Auto || algo == GemmAlgo::Packed) {
+        // Plain C = A * B or C += A * B of a fixed-size shape: the
+        // accumulating kernel after clearing C is cheaper than packing.
+        SmallGemmKernel<T, Acc> fixed = algo == GemmAlgo::Auto && M == N && N == K
+                                            ? small_gemm_kernel<T, Acc>(M) : nullptr;
+        if (fixed && transA == Trans::No && transB == Trans::No && alpha == Acc(1)
+            && (beta == Acc(0) || beta == Acc(1))) {
+            scale_matrix<T, Acc>(M, N, beta, C, ldc);
+            fixed(A, lda, B, ldb, C, ldc);
+            return;
+        }
+        packed_gemm<T, Acc>(transA == Trans::Yes, transB == Trans::Yes, M, N, K, alpha,
+                            A, lda, B, ldb, beta, C, ldc, threadCount);
+        return;
+    }
+
+    scale_matrix<T, Acc>(M, N, beta, C, ldc);
+    if (K <= 0 || alpha == Acc(0))
+        return;
+
+    Matrix<T> copyA, copyB;
+    MatrixView<const T> a = operand(transA, A, lda, M, K, copyA);
+    MatrixView<const T> b = operand(transB, B, ldb, K, N, copyB);
+    MatrixView<Acc> c(C, M, N, ldc);
+
+    if (alpha == Acc(1)) {
+        accumulate<T, Acc>(algo, a, b, c, threadCount);
+        return;
+    }
+    Matrix<Acc> product(M, N);
+    accumulate<T, Acc>(algo, a, b, product, threadCount);
+    for (int i = 0; i < M; ++i)
+        for (int j = 0; j < N; ++j)
+            c(i, j) += alpha * product(i, j);
+}
+
+#define CAMM_INSTANTIATE_GEMM(T, Acc)                                                       \
+    template void gemm<T, Acc>(Trans, Trans, int, int, int, Acc, const T*, int, const T*, int, \
+                               Acc, Acc*, int, GemmAlgo, int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_GEMM)
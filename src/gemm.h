@@ -0,0 +1,44 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+// Whether an operand is used as stored or transposed (BLAS 'N' / 'T').
+enum class Trans {
+    No,
+    Yes
+};
+
+// The algorithm behind gemm(). Auto runs the fixed-size kernel for the shapes
+// that have one and packed_gemm for everything else.
+enum class GemmAlgo {
+    Auto,
+    Naive,
+    CacheAware,
+    CacheOblivious,
+    ObliviousParallel,
+    Morton,
+    OneD,
+    Packed,
+    Strassen
+};
+
+/**
+ * BLAS-style C(MxN) = alpha * op(A) * op(B) + beta * C, with op(A) M x K and
+ * op(B) K x N, all row-major with leading dimensions lda/ldb/ldc (so A is
+ * stored K x M when transA is Trans::Yes, B likewise N x K). With beta == 0,
+ * C is an output only: it is never read, so it need not be initialised.
+ *
+ * Auto and Packed read the transposes while packing and apply alpha/beta when
+ * each tile of C is stored, so they take no extra passes. The other algorithms
+ * compute C += A * B only: they get transposed copies of A and B, C is
+ * scaled by beta beforehand and, for alpha != 1, the product goes through a
+ * temporary. threadCount <= 0 lets each algorithm pick its own task count.
+ * Instantiated for every type pair in matmul_types.h.
+ */
+template <typename T, typename Acc>
+void gemm(Trans transA, Trans transB, int M, int N, int K, Acc alpha,
+          const T* A, int lda,
+          const T* B, int ldb,
+          Acc beta, Acc* C, int ldc,
+          GemmAlgo algo = GemmAlgo::Auto, int threadCount = 0);
+
+#endif // GEMM_H
@@ -1,25 +1,1105 @@
 #include <iostream>
 #include <vector>
+#include <array>
 #include <chrono>
 #include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <thread>
+#include <iterator>
+#include <string>
+#include <future>
+#include <filesystem>
 #include "kaizen.h"
 #include "naive_matmul.h"
 #include "cache_aware_matmul.h"
 #include "cache_oblivious_matmul.h"
 #include "cache_utils.h"
 #include "cache_aware_matmul_1D.h" 
+#include "aligned_buffer.h"
+#include "async_matmul.h"
+#include "batched_matmul.h"
+#include "benchmark_harness.h"
+#include "buffer_pool.h"
+#include "gemm.h"
+#include "matrix.h"
+#include "morton_matrix.h"
+#include "out_of_core_matmul.h"
+#include "packed_matmul.h"
+#include "perf_counters.h"
+#include "roofline.h"
+#include "simd_kernels.h"
+#include "strassen_matmul.h"
+#include "task_scheduler.h"
+#include "thread_affinity.h"
+#include "tuning.h"
+#include "verify.h"
+#include "matmul_types.h"
 
 using Clock = std::chrono::high_resolution_clock;
 
 constexpr int DEFAULT_SIZE = 1024;
 
+// --verify: inputs of size n come from VERIFY_SEED + n, so a failure reproduces.
+constexpr std::uint64_t VERIFY_SEED = 0x5eed;
+
+// One indented line of counts under a timing line; nothing if none were counted.
+static void print_counters(const PerfSample& perf)
+{
+    if (!perf.any())
+        return;
+    const char* labels[PERF_EVENT_COUNT] = { "cycles", "instructions", "L1D misses", "LLC misses",
+                                             "dTLB misses" };
+    std::cout << "    ";
+    const char* separator = "";
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        if (perf.counts[e] < 0)
+            continue;
+        std::cout << separator << labels[e] << " " << perf.counts[e];
+        separator = ", ";
+    }
+    if (perf[PerfEvent::Cycles] > 0 && perf[PerfEvent::Instructions] >= 0)
+        std::cout << " (IPC " << double(perf[PerfEvent::Instructions]) / perf[PerfEvent::Cycles] << ")";
+    std::cout << "\n";
+}
+
+// CSV columns <prefix><event>; uncounted events are left empty.
+static void write_counter_header(std::ostream& csv, const std::string& prefix)
+{
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e)
+        csv << "," << prefix << perf_event_name(static_cast<PerfEvent>(e));
+}
+
+static void write_counters(std::ostream& csv, const PerfSample& perf)
+{
+    for (long long count : perf.counts) {
+        csv << ",";
+        if (count >= 0)
+            csv << count;
+    }
+}
+
+// Timings of one Morton-layout multiply, with the layout conversion kept apart.
+struct MortonTiming {
+    double multiply_ms;
+    double convert_ms;   // A, B to Morton + C back to row-major
+    PerfSample perf;     // of the multiply alone
+};
+
+/**
+ * C = A * B through the Morton layout, like gemm() with beta = 0: the Morton
+ * C starts zeroed and overwrites C on the way back. Storage is allocated up
+ * front so only the conversions themselves count towards convert_ms.
+ */
+template <typename T, typename Acc>
+static MortonTiming time_morton_matmul(const Matrix<T>& A, const Matrix<T>& B, Matrix<Acc>& C,
+                                       PerfCounters& counters)
+{
+    int grid = morton_grid_for(std::max({A.rows(), A.cols(), B.cols()}));
+    MortonMatrix<T>   Am(A.rows(), A.cols(), grid);
+    MortonMatrix<T>   Bm(B.rows(), B.cols(), grid);
+    MortonMatrix<Acc> Cm(C.rows(), C.cols(), grid);
+
+    auto t0 = Clock::now();
+    to_morton<T>(A, Am);
+    to_morton<T>(B, Bm);
+    counters.start();
+    auto t1 = Clock::now();
+    cache_oblivious_matmul_morton<T, Acc>(Am, Bm, Cm);
+    auto t2 = Clock::now();
+    PerfSample perf = counters.stop();
+    from_morton<Acc>(Cm, C);
+    auto t3 = Clock::now();
+
+    MortonTiming timing;
+    timing.multiply_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    timing.convert_ms  = std::chrono::duration<double, std::milli>((t1 - t0) + (t3 - t2)).count();
+    timing.perf        = perf;
+    return timing;
+}
+
+// Task count for a benchmarked kernel of size n: the tuned value, else 8.
+template <typename T, typename Acc>
+static int bench_threads(TuneKey key, int n)
+{
+    return tuned_value(key, dtype_of<T, Acc>(), n, n, n, 8);
+}
+
+// The benchmarked algorithms in report order. `flag` is the --algos name,
+// `column` the results.csv column.
+enum class Algo {
+    Naive,
+    CacheAware,
+    CacheOblivious,
+    ObliviousParallel,
+    Morton,
+    OneD,
+    Packed,
+    Strassen
+};
+
+struct AlgoInfo {
+    Algo algo;
+    const char* flag;
+    const char* column;
+};
+
+static const AlgoInfo ALGORITHMS[] = {
+    { Algo::Naive,             "naive",              "Naive" },
+    { Algo::CacheAware,        "aware",              "CacheAware" },
+    { Algo::CacheOblivious,    "oblivious",          "CacheOblivious" },
+    { Algo::ObliviousParallel, "oblivious-parallel", "CacheObliviousParallel" },
+    { Algo::Morton,            "morton",             "CacheObliviousMorton" },
+    { Algo::OneD,              "1d",                 "CacheAware1D" },
+    { Algo::Packed,            "packed",             "Packed" },
+    { Algo::Strassen,          "strassen",           "Strassen" },
+};
+
+static const AlgoInfo& algo_info(Algo algo)
+{
+    return ALGORITHMS[static_cast<int>(algo)];
+}
+
+// What the benchmark runs, from the command line.
+struct BenchOptions {
+    std::vector<Algo> algos;     // in ALGORITHMS order
+    int threads = 0;             // tasks for 1D, packed and Strassen; 0 = tuned, else 8
+    RepetitionPlan plan;
+    int sweepStart = 1012;
+    int sweepEnd = 1036;
+    int sweepStep = 1;
+    int verifyRounds = 0;        // --verify: Freivalds rounds after every timed run, 0 = off
+};
+
+// All repetitions of one algorithm at one size.
+struct AlgoRun {
+    std::vector<Measurement> samples;
+    SampleStats stats;
+    double convert_ms = 0;       // Morton: median layout conversion time
+    int tasks = 1;               // tasks (1D, packed, Strassen) or pool workers in use
+    double model_bytes = 0;      // DRAM traffic of one run, see traffic_model_bytes
+    bool failed = false;         // --verify rejected a result; samples stop there
+};
+
+/**
+ * Estimated DRAM traffic of one n x n x n run, from the reuse each algorithm
+ * gets out of the last-level cache (the other levels only decide how fast
+ * that traffic is consumed). Operands that fit in half the LLC are read once;
+ * otherwise:
+ *   naive:            B is streamed once per row of C
+ *   cache-aware / 1D: B once per tile row (n / b times), A strips are reused
+ *   oblivious:        the recursion reaches blocks of edge s with three s x s
+ *                     blocks in the LLC, so A and B are read n / s times
+ *   packed:           A once per NC panel, C once per KC panel, B once per task
+ *   Strassen:         packed at the crossover, plus the temporaries' reads and
+ *                     writes on every level above it
+ * C is always counted read and written once more.
+ */
+template <typename T, typename Acc>
+static double traffic_model_bytes(Algo algo, int n, int cacheLine, int l1Cache, int tasks)
+{
+    const double nn = double(n) * n;
+    const double a = nn * sizeof(T), b = nn * sizeof(T), c = nn * sizeof(Acc);
+    const double llc = double(std::max(get_l3_cache_size(), get_l2_cache_size()));
+    auto fits = [&](double bytes) { return bytes <= llc / 2; };
+    auto passes = [&](int edge) { return std::ceil(double(n) / std::max(edge, 1)); };
+
+    auto packed = [&](int m) {
+        PackedBlocking blk = packed_blocking_from_caches(sizeof(T));
+        double mm = double(m) * m;
+        return mm * sizeof(T) * (std::ceil(double(m) / blk.nc) + tasks)
+             + 2 * mm * sizeof(Acc) * std::ceil(double(m) / blk.kc);
+    };
+
+    switch (algo) {
+    case Algo::Naive:
+        return a + 2 * c + (fits(b) ? b : n * b);
+    case Algo::CacheAware:
+    case Algo::OneD: {
+        int edge = algo == Algo::OneD ? cache_aware_1D_tile_size<T, Acc>(n, n, n)
+                                      : cache_aware_block_size<T, Acc>(n, n, n, cacheLine, l1Cache);
+        double strip = double(edge) * n * sizeof(T);
+        return (fits(strip) ? a : a * passes(edge)) + (fits(b) ? b : b * passes(edge)) + 2 * c;
+    }
+    case Algo::CacheOblivious:
+    case Algo::ObliviousParallel:
+    case Algo::Morton: {
+        int edge = static_cast<int>(std::sqrt(llc / (3.0 * std::max(sizeof(T), sizeof(Acc)))));
+        return edge >= n ? a + b + 2 * c : (a + b) * (double(n) / edge) + 2 * c;
+    }
+    case Algo::Packed:
+        return packed(n);
+    case Algo::Strassen: {
+        // 7 products per level; about 15 half-size temporaries formed or
+        // accumulated per level, each reading two operands and writing one.
+        int crossover = strassen_crossover<T, Acc>();
+        double bytes = std::is_same<T, Acc>::value ? 0 : 2 * nn * (sizeof(T) + sizeof(Acc));
+        double products = 1;
+        int m = n;
+        while (m > crossover) {
+            double half = double(m / 2) * (m / 2);
+            bytes += products * 15 * 3 * half * sizeof(Acc);
+            products *= 7;
+            m /= 2;
+        }
+        return bytes + products * packed(m);
+    }
+    }
+    return a + b + 2 * c;
+}
+
+// Traffic of one run: LLC read misses x line size where the counter works,
+// else the model.
+static double run_bytes(const Measurement& sample, double modelBytes, int cacheLine)
+{
+    long long misses = sample.perf[PerfEvent::LLCMisses];
+    return misses >= 0 ? double(misses) * cacheLine : modelBytes;
+}
+
+template <typename T, typename Acc>
+static AlgoRun run_algorithm(Algo algo, const BenchOptions& opts, const Matrix<T>& A,
+                             const Matrix<T>& B, Matrix<Acc>& C, int cacheLine, int l1Cache)
+{
+    AlgoRun run;
+    int n = C.rows();
+    if (algo == Algo::OneD || algo == Algo::Packed || algo == Algo::Strassen) {
+        TuneKey key = algo == Algo::OneD ? TuneKey::Threads1D : TuneKey::PackedThreads;
+        run.tasks = opts.threads > 0 ? opts.threads : bench_threads<T, Acc>(key, n);
+    } else if (algo == Algo::ObliviousParallel) {
+        run.tasks = TaskScheduler::instance().worker_count();
+    }
+    const int tasks = run.tasks;
+    // Only packed GEMM writes C without reading it (beta = 0). The others
+    // accumulate, so C is cleared here, outside the timed region, and they
+    // run with beta = 1 to leave it as it is.
+    const bool accumulates = algo != Algo::Packed && algo != Algo::Morton;
+    auto reset = [&] {
+        if (accumulates)
+            C.zero();
+    };
+
+    // --verify: Freivalds' check of C after every timed run.
+    auto check = [&](int repetition) {
+        if (opts.verifyRounds <= 0)
+            return true;
+        VerifyResult v = freivalds_check<T, Acc>(A, B, C, opts.verifyRounds, VERIFY_SEED + repetition);
+        if (!v.ok) {
+            std::cerr << "Verification FAILED: " << algo_info(algo).column << " at n=" << n
+                      << ", repetition " << repetition << ", row " << v.row << " (Freivalds round "
+                      << v.round;
+            if (v.tolerance > 0)
+                std::cerr << ", error " << v.error << " > tolerance " << v.tolerance;
+            std::cerr << ")\n";
+            run.failed = true;
+        }
+        return v.ok;
+    };
+    auto repeat = [&](auto&& fn) { return run_repeated(opts.plan, reset, fn, check); };
+
+    // Every algorithm runs behind gemm().
+    const Acc beta = accumulates ? Acc(1) : Acc(0);
+    auto multiply = [&](GemmAlgo kernel) {
+        return repeat([&] {
+            gemm<T, Acc>(Trans::No, Trans::No, n, n, n, Acc(1), A.data(), A.ld(), B.data(), B.ld(),
+                         beta, C.data(), C.ld(), kernel, tasks);
+        });
+    };
+
+    switch (algo) {
+    case Algo::Naive:
+        run.samples = multiply(GemmAlgo::Naive);
+        break;
+    case Algo::CacheAware:
+        run.samples = multiply(GemmAlgo::CacheAware);
+        break;
+    case Algo::CacheOblivious:
+        run.samples = multiply(GemmAlgo::CacheOblivious);
+        break;
+    case Algo::ObliviousParallel:
+        run.samples = multiply(GemmAlgo::ObliviousParallel);
+        break;
+    case Algo::Morton: {
+        // Timed inside time_morton_matmul, so the conversions can be split off.
+        PerfCounters counters;
+        std::vector<double> convert;
+        for (int r = 0; r < opts.plan.warmup + opts.plan.iterations; ++r) {
+            MortonTiming timing = time_morton_matmul(A, B, C, counters);
+            if (r < opts.plan.warmup)
+                continue;
+            run.samples.push_back(Measurement{ timing.multiply_ms, timing.perf });
+            convert.push_back(timing.convert_ms);
+            if (!check(r - opts.plan.warmup))
+                break;
+        }
+        std::sort(convert.begin(), convert.end());
+        run.convert_ms = convert[(convert.size() - 1) / 2];
+        break;
+    }
+    case Algo::OneD:
+        run.samples = multiply(GemmAlgo::OneD);
+        break;
+    case Algo::Packed:
+        run.samples = multiply(GemmAlgo::Packed);
+        break;
+    case Algo::Strassen:
+        run.samples = multiply(GemmAlgo::Strassen);
+        break;
+    }
+    run.stats = summarize(run.samples);
+    run.model_bytes = traffic_model_bytes<T, Acc>(algo, n, cacheLine, l1Cache, run.tasks);
+    return run;
+}
+
+/**
+ * The headline line of one algorithm (median time, in the wording CI checks),
+ * then the spread over the repetitions with every sample, then the counters
+ * of the median run.
+ */
+template <typename T, typename Acc>
+static void report(Algo algo, const AlgoRun& run, int n, int cacheLine, const MachineCeilings& roof)
+{
+    double ms = run.stats.median;
+    switch (algo) {
+    case Algo::Naive:
+        std::cout << "Naive matmul time: " << ms << " ms\n";
+        break;
+    case Algo::CacheAware:
+        std::cout << "Cache-aware matmul time: " << ms << " ms\n";
+        break;
+    case Algo::CacheOblivious:
+        std::cout << "Cache-oblivious matmul time: " << ms << " ms\n";
+        break;
+    case Algo::ObliviousParallel:
+        std::cout << "Parallel cache-oblivious matmul (" << TaskScheduler::instance().worker_count()
+                  << " workers) time: " << ms << " ms\n";
+        break;
+    case Algo::Morton:
+        std::cout << "Cache-oblivious (Morton layout) matmul time: " << ms
+                  << " ms (+ " << run.convert_ms << " ms layout conversion)\n";
+        break;
+    case Algo::OneD:
+        std::cout << "1D matmul (thread pool, " << run.tasks << " tasks) took " << ms << " ms.\n";
+        break;
+    case Algo::Packed: {
+        PackedBlocking blk = packed_blocking_from_caches(sizeof(T));
+        std::cout << "Packed GEMM (" << PACK_MR << "x" << PACK_NR << " microkernel, MC=" << blk.mc
+                  << " KC=" << blk.kc << " NC=" << blk.nc << ", " << run.tasks
+                  << " tasks) took " << ms << " ms.\n";
+        break;
+    }
+    case Algo::Strassen:
+        std::cout << "Strassen-Winograd (crossover " << strassen_crossover<T, Acc>() << ", "
+                  << run.tasks << " tasks) took " << ms << " ms.\n";
+        break;
+    }
+
+    const SampleStats& s = run.stats;
+    std::cout << "    " << s.count << " runs: min " << s.min << ", median " << s.median
+              << ", mean " << s.mean << " +- " << s.stddev << ", p95 " << s.p95 << " ms; "
+              << 2.0 * n * n * n / (s.median * 1e6) << " GOP/s; samples";
+    for (const Measurement& sample : run.samples)
+        std::cout << " " << sample.ms;
+    std::cout << "\n";
+    print_counters(median_sample(run.samples).perf);
+
+    // Counters come from the median repetition; the time is the same
+    // interpolated median as the headline.
+    const Measurement& median = median_sample(run.samples);
+    bool counted = median.perf[PerfEvent::LLCMisses] >= 0;
+    RooflinePoint point = place_on_roofline(2.0 * n * n * n, run_bytes(median, run.model_bytes, cacheLine),
+                                            run.stats.median, roof);
+    std::cout << "    traffic " << run_bytes(median, run.model_bytes, cacheLine) / (1 << 20) << " MiB ("
+              << (counted ? "LLC misses" : "model") << "), " << point.gbs << " GB/s, "
+              << point.intensity << " op/B\n";
+}
+
+/**
+ * One line per algorithm: achieved GOP/s at its arithmetic intensity, which
+ * roof limits it there and how close it gets.
+ */
+static void print_roofline(const std::vector<std::pair<Algo, RooflinePoint>>& points,
+                           const MachineCeilings& roof)
+{
+    std::cout << "Roofline: compute roof " << roof.peak_gops << " GOP/s, memory roof "
+              << roof.bandwidth_gbs << " GB/s, ridge at " << roof.peak_gops / roof.bandwidth_gbs
+              << " op/B\n";
+    for (const auto& entry : points) {
+        const RooflinePoint& p = entry.second;
+        std::cout << "  " << algo_info(entry.first).column << ": " << p.gops << " GOP/s at "
+                  << p.intensity << " op/B, " << (p.memory_bound ? "memory" : "compute")
+                  << "-bound, " << 100.0 * p.efficiency << "% of attainable " << p.attainable_gops
+                  << " GOP/s\n";
+    }
+}
+
+/**
+ * Runs the selected algorithms with inputs of type T accumulated in Acc:
+ * first at `size` with a report per algorithm, then over the sweep sizes.
+ * The sweep writes results.csv (median per algorithm and size, counters of
+ * the median run), results_summary.csv (the full statistics) and
+ * results_samples.csv (every timed repetition). With --verify the inputs are
+ * random and every run is checked; returns false at the first wrong result.
+ */
+template <typename T, typename Acc>
+static bool run_benchmarks(int size, int cacheLine, int l1Cache, const BenchOptions& opts,
+                           const MachineCeilings& roof)
+{
+    std::cout << "Repetitions: " << opts.plan.warmup << " warm-up + " << opts.plan.iterations
+              << " timed per algorithm and size\n";
+    if (opts.verifyRounds > 0)
+        std::cout << "Verification: random inputs, " << opts.verifyRounds
+                  << " Freivalds rounds after every timed run\n";
+
+    Matrix<T>   A(size, size, T(1));
+    Matrix<T>   B(size, size, T(1));
+    Matrix<Acc> C(size, size);
+    if (opts.verifyRounds > 0)
+        randomize_inputs<T, Acc>(A, B, VERIFY_SEED + size);
+
+    if (huge_pages_enabled()) {
+        HugePageStats pages = huge_page_stats();
+        std::cout << "Huge pages: " << (pages.hugetlb_bytes >> 20) << " MiB MAP_HUGETLB, "
+                  << (pages.madvised_bytes >> 20) << " MiB THP-advised, "
+                  << (pages.thp_resident_bytes >> 20) << " MiB resident as THP"
+                  << (pages.hugetlb_bytes + pages.thp_resident_bytes == 0 ? " (none obtained)" : "")
+                  << "\n";
+    }
+
+    std::vector<std::pair<Algo, RooflinePoint>> points;
+    for (Algo algo : opts.algos) {
+        AlgoRun run = run_algorithm<T, Acc>(algo, opts, A, B, C, cacheLine, l1Cache);
+        if (run.failed)
+            return false;
+        report<T, Acc>(algo, run, size, cacheLine, roof);
+        const Measurement& median = median_sample(run.samples);
+        points.emplace_back(algo, place_on_roofline(2.0 * size * size * size,
+                                                    run_bytes(median, run.model_bytes, cacheLine),
+                                                    run.stats.median, roof));
+    }
+    print_roofline(points, roof);
+
+    //--------------------------------------------------------------------------
+    // Sweep over --sizes, write the CSVs
+    //--------------------------------------------------------------------------
+    std::ofstream csv("results.csv");
+    std::ofstream summary("results_summary.csv");
+    std::ofstream samples("results_samples.csv");
+
+    csv << "Size,Naive,CacheAware,CacheOblivious,CacheAware1D,Packed,CacheObliviousMorton,MortonConversion,CacheObliviousParallel,Strassen";
+    for (const AlgoInfo& info : ALGORITHMS)
+        csv << "," << info.column << "_GOPs";
+    for (const AlgoInfo& info : ALGORITHMS)
+        write_counter_header(csv, std::string(info.column) + "_");
+    csv << "\n";
+    summary << "Size,Algorithm,Tasks,Runs,Min,Median,Mean,Stddev,P95,GOPs,TrafficBytes,TrafficSource,"
+               "GBs,Intensity,AttainableGOPs,Efficiency,Bound\n";
+    samples << "Size,Algorithm,Tasks,Repetition,Milliseconds,GOPs,TrafficBytes,GBs";
+    write_counter_header(samples, "");
+    samples << "\n";
+
+    for (int test_size = opts.sweepStart; test_size <= opts.sweepEnd; test_size += opts.sweepStep) {
+        // --- Prepare data once; every approach runs on the same contiguous matrices ---
+        Matrix<T>   A2(test_size, test_size, T(1));
+        Matrix<T>   B2(test_size, test_size, T(1));
+        Matrix<Acc> C2(test_size, test_size);
+        if (opts.verifyRounds > 0)
+            randomize_inputs<T, Acc>(A2, B2, VERIFY_SEED + test_size);
+
+        std::vector<AlgoRun> runs(std::size(ALGORITHMS));
+        std::vector<bool> ran(std::size(ALGORITHMS), false);
+        const double ops = 2.0 * test_size * test_size * test_size;
+        for (Algo algo : opts.algos) {
+            int index = static_cast<int>(algo);
+            runs[index] = run_algorithm<T, Acc>(algo, opts, A2, B2, C2, cacheLine, l1Cache);
+            ran[index] = true;
+            if (runs[index].failed)
+                return false;
+
+            const AlgoRun& run = runs[index];
+            const SampleStats& s = run.stats;
+            const Measurement& median = median_sample(run.samples);
+            double bytes = run_bytes(median, run.model_bytes, cacheLine);
+            RooflinePoint point = place_on_roofline(ops, bytes, s.median, roof);
+            summary << test_size << "," << algo_info(algo).column << "," << run.tasks << ","
+                    << s.count << "," << s.min << "," << s.median << "," << s.mean << ","
+                    << s.stddev << "," << s.p95 << "," << point.gops << "," << bytes << ","
+                    << (median.perf[PerfEvent::LLCMisses] >= 0 ? "llc-misses" : "model") << ","
+                    << point.gbs << "," << point.intensity << "," << point.attainable_gops << ","
+                    << point.efficiency << "," << (point.memory_bound ? "memory" : "compute") << "\n";
+            for (std::size_t r = 0; r < run.samples.size(); ++r) {
+                const Measurement& sample = run.samples[r];
+                double sampleBytes = run_bytes(sample, run.model_bytes, cacheLine);
+                samples << test_size << "," << algo_info(algo).column << "," << run.tasks << ","
+                        << r << "," << sample.ms << "," << ops / (sample.ms * 1e6) << ","
+                        << sampleBytes << "," << sampleBytes / (sample.ms * 1e6);
+                write_counters(samples, sample.perf);
+                samples << "\n";
+            }
+        }
+
+        // One results.csv row of medians; algorithms not selected stay empty.
+        auto cell = [&](Algo algo, bool conversion) {
+            const AlgoRun& run = runs[static_cast<int>(algo)];
+            csv << ",";
+            if (ran[static_cast<int>(algo)])
+                csv << (conversion ? run.convert_ms : run.stats.median);
+        };
+        csv << test_size;
+        for (Algo algo : { Algo::Naive, Algo::CacheAware, Algo::CacheOblivious, Algo::OneD, Algo::Packed,
+                           Algo::Morton })
+            cell(algo, false);
+        cell(Algo::Morton, true);
+        cell(Algo::ObliviousParallel, false);
+        cell(Algo::Strassen, false);
+        for (const AlgoInfo& info : ALGORITHMS) {
+            csv << ",";
+            if (ran[static_cast<int>(info.algo)])
+                csv << ops / (runs[static_cast<int>(info.algo)].stats.median * 1e6);
+        }
+        for (const AlgoInfo& info : ALGORITHMS) {
+            int index = static_cast<int>(info.algo);
+            write_counters(csv, ran[index] ? median_sample(runs[index].samples).perf : PerfSample());
+        }
+        csv << "\n";
+    }
+    return true;
+}
+
+/**
+ * Cache-oblivious throughput around powers of two and on rectangular shapes.
+ * With all-ones inputs every entry of C must equal K, which also catches
+ * skipped remainder rows/columns. Writes oblivious_sweep.csv.
+ */
+template <typename T, typename Acc>
+static bool run_oblivious_sweep()
+{
+    std::vector<std::array<int, 3>> shapes; // M, K, N
+    for (int p : {128, 256, 512, 1024})
+        for (int d : {-1, 0, 1})
+            shapes.push_back({p + d, p + d, p + d});
+    shapes.push_back({1013, 517, 2048});
+    shapes.push_back({2047, 64, 1025});
+    shapes.push_back({333, 1999, 777});
+
+    std::ofstream csv("oblivious_sweep.csv");
+    csv << "M,K,N,Milliseconds,GOPs,Correct\n";
+
+    bool allCorrect = true;
+    for (const auto& shape : shapes) {
+        int M = shape[0], K = shape[1], N = shape[2];
+        Matrix<T>   A(M, K, T(1));
+        Matrix<T>   B(K, N, T(1));
+        Matrix<Acc> C(M, N);
+
+        auto start = Clock::now();
+        cache_oblivious_matmul<T, Acc>(A, B, C);
+        auto end   = Clock::now();
+        double ms   = std::chrono::duration<double, std::milli>(end - start).count();
+        double gops = 2.0 * M * N * K / (ms * 1e6);
+
+        bool correct = true;
+        for (int i = 0; i < M && correct; ++i)
+            for (int j = 0; j < N; ++j)
+                if (C(i, j) != static_cast<Acc>(K)) { correct = false; break; }
+        allCorrect = allCorrect && correct;
+
+        std::cout << "Cache-oblivious " << M << "x" << K << "x" << N << ": "
+                  << ms << " ms, " << gops << " GOP/s" << (correct ? "" : "  WRONG RESULT") << "\n";
+        csv << M << "," << K << "," << N << "," << ms << "," << gops << ","
+            << (correct ? 1 : 0) << "\n";
+    }
+
+    std::cout << "Sweep CSV written to oblivious_sweep.csv\n";
+    return allCorrect;
+}
+
+// Average milliseconds per call of fn over `reps` calls (after one warm-up call).
+template <typename Fn>
+static double per_call_ms(int reps, Fn&& fn)
+{
+    fn();
+    auto start = Clock::now();
+    for (int r = 0; r < reps; ++r)
+        fn();
+    auto end = Clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / reps;
+}
+
+/**
+ * Per-call cost of the persistent pool at small sizes. For each n the 1D and
+ * packed kernels are timed per call, next to the fork-join overhead alone:
+ * spawning and joining threadCount fresh std::threads (what every call used
+ * to pay) versus dispatching threadCount empty tasks on the pool.
+ * Writes pool_latency.csv.
+ */
+template <typename T, typename Acc>
+static void run_pool_latency(int threadCount)
+{
+    std::ofstream csv("pool_latency.csv");
+    csv << "Size,CacheAware1D,Packed,ThreadSpawn,PoolDispatch,Saved\n";
+
+    const int overheadReps = 200;
+    double spawn_ms = per_call_ms(overheadReps, [&] {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t)
+            threads.emplace_back([] {});
+        for (auto &th : threads)
+            th.join();
+    });
+    double dispatch_ms = per_call_ms(overheadReps, [&] { parallel_for(threadCount, [](int) {}); });
+    double saved_ms = spawn_ms - dispatch_ms;
+
+    std::cout << "Fork-join of " << threadCount << " tasks: std::thread " << spawn_ms * 1000
+              << " us, pool (" << TaskScheduler::instance().worker_count() << " workers) "
+              << dispatch_ms * 1000 << " us per call\n";
+
+    for (int n : {64, 128, 256, 512}) {
+        Matrix<T>   A(n, n, T(1));
+        Matrix<T>   B(n, n, T(1));
+        Matrix<Acc> C(n, n);
+        int reps = std::max(5, static_cast<int>(2e8 / (double(n) * n * n)));
+
+        double oneD_ms   = per_call_ms(reps, [&] { cache_aware_matmul_1D<T, Acc>(A, B, C, threadCount); });
+        double packed_ms = per_call_ms(reps, [&] { packed_matmul<T, Acc>(A, B, C, threadCount); });
+
+        std::cout << "n=" << n << ": 1D " << oneD_ms * 1000 << " us, packed " << packed_ms * 1000
+                  << " us per call; pool saves " << saved_ms * 1000 << " us per call ("
+                  << 100.0 * saved_ms / (packed_ms + saved_ms) << "% of a packed call)\n";
+        csv << n << "," << oneD_ms << "," << packed_ms << "," << spawn_ms << ","
+            << dispatch_ms << "," << saved_ms << "\n";
+    }
+
+    std::cout << "Pool latency CSV written to pool_latency.csv\n";
+}
+
+/**
+ * Throughput of batched small products: for each edge n, `batch` independent
+ * n x n products (default about 4M elements per operand) through the strided
+ * and the pointer-array batched API, next to a loop calling packed_gemm once
+ * per product on one task, the cheapest way to do it with the large-matrix
+ * API. Edge 24 has no fixed-size kernel and shows the generic path. With
+ * --verify every product of the strided run is checked. Writes batched.csv.
+ */
+template <typename T, typename Acc>
+static bool run_batched(const BenchOptions& opts, int batchOverride)
+{
+    std::ofstream csv("batched.csv");
+    csv << "Size,Batch,Kernel,Strided,Pointers,PerCall,StridedMatricesPerSec,"
+           "PointersMatricesPerSec,PerCallMatricesPerSec,StridedGOPs\n";
+
+    for (int n : { 4, 8, 16, 24, 32, 64 }) {
+        const int batch = batchOverride > 0 ? batchOverride : std::max(256, (1 << 22) / (n * n));
+        // One matrix per row: matrix i starts at data() + i * ld().
+        Matrix<T>   A(batch, n * n);
+        Matrix<T>   B(batch, n * n);
+        Matrix<Acc> C(batch, n * n);
+        if (opts.verifyRounds > 0) {
+            randomize_inputs<T, Acc>(A, B, VERIFY_SEED + n);
+        } else {
+            A.fill(T(1));
+            B.fill(T(1));
+        }
+
+        std::vector<const T*> Ap(batch), Bp(batch);
+        std::vector<Acc*> Cp(batch);
+        for (int i = 0; i < batch; ++i) {
+            Ap[i] = A.data() + std::ptrdiff_t(i) * A.ld();
+            Bp[i] = B.data() + std::ptrdiff_t(i) * B.ld();
+            Cp[i] = C.data() + std::ptrdiff_t(i) * C.ld();
+        }
+
+        // The batched kernels accumulate into C.
+        auto reset = [&] { C.zero(); };
+        auto median_ms = [&](auto&& fn) { return summarize(run_repeated(opts.plan, reset, fn)).median; };
+        double pointers_ms = median_ms([&] {
+            batched_matmul<T, Acc>(n, n, n, Ap.data(), n, Bp.data(), n, Cp.data(), n, batch, opts.threads);
+        });
+        double percall_ms = median_ms([&] {
+            for (int i = 0; i < batch; ++i)
+                packed_gemm<T, Acc>(n, n, n, Ap[i], n, Bp[i], n, Cp[i], n, 1);
+        });
+        double strided_ms = median_ms([&] {
+            batched_matmul_strided<T, Acc>(n, n, n, A.data(), n, A.ld(), B.data(), n, B.ld(), C.data(), n,
+                                           C.ld(), batch, opts.threads);
+        });
+
+        if (opts.verifyRounds > 0) {
+            for (int i = 0; i < batch; ++i) {
+                VerifyResult v = freivalds_check<T, Acc>(MatrixView<const T>(Ap[i], n, n, n),
+                                                         MatrixView<const T>(Bp[i], n, n, n),
+                                                         MatrixView<const Acc>(Cp[i], n, n, n),
+                                                         opts.verifyRounds, VERIFY_SEED + i);
+                if (!v.ok) {
+                    std::cerr << "Verification FAILED: batched " << n << "x" << n << ", matrix " << i
+                              << " of " << batch << ", row " << v.row << "\n";
+                    return false;
+                }
+            }
+        }
+
+        const char* kernel = small_gemm_kernel<T, Acc>(n) ? "fixed" : "generic";
+        auto per_sec = [&](double ms) { return batch / (ms * 1e-3); };
+        double gops = 2.0 * n * n * n * batch / (strided_ms * 1e6);
+        std::cout << "Batched " << n << "x" << n << " (" << batch << " matrices, " << kernel
+                  << " kernel): strided " << per_sec(strided_ms) / 1e6 << " M matrices/s ("
+                  << gops << " GOP/s), pointers " << per_sec(pointers_ms) / 1e6
+                  << " M/s, per-call packed_gemm " << per_sec(percall_ms) / 1e6 << " M/s\n";
+        csv << n << "," << batch << "," << kernel << "," << strided_ms << "," << pointers_ms << ","
+            << percall_ms << "," << per_sec(strided_ms) << "," << per_sec(pointers_ms) << ","
+            << per_sec(percall_ms) << "," << gops << "\n";
+    }
+    std::cout << "Batched CSV written to batched.csv\n";
+    return true;
+}
+
+/**
+ * One n x n product submitted together with `jobs` - 1 small ones (64 to 256,
+ * cycling), first in turn through blocking gemm() calls, big one first, then
+ * all at once through gemm_async. Prints the wall time of the whole set and
+ * the median time until a small job's C is ready, where interleaving shows.
+ * With --verify every product is checked after both runs. Writes async.csv.
+ */
+template <typename T, typename Acc>
+static bool run_async(const BenchOptions& opts, int n, int jobs)
+{
+    std::vector<int> sizes{ n };
+    for (int i = 1; i < jobs; ++i)
+        sizes.push_back(64 << (i % 3));
+    std::vector<Matrix<T>> A, B;
+    std::vector<Matrix<Acc>> C;
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        A.emplace_back(sizes[i], sizes[i], T(1));
+        B.emplace_back(sizes[i], sizes[i], T(1));
+        C.emplace_back(sizes[i], sizes[i]);
+        if (opts.verifyRounds > 0)
+            randomize_inputs<T, Acc>(A[i], B[i], VERIFY_SEED + i);
+    }
+
+    auto since = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    auto median_of_small = [](std::vector<double> ready) {
+        ready.erase(ready.begin());
+        std::sort(ready.begin(), ready.end());
+        return ready.empty() ? 0.0 : ready[(ready.size() - 1) / 2];
+    };
+    auto verify = [&](const char* mode) {
+        for (std::size_t i = 0; opts.verifyRounds > 0 && i < sizes.size(); ++i) {
+            VerifyResult v = freivalds_check<T, Acc>(A[i], B[i], C[i], opts.verifyRounds, VERIFY_SEED + i);
+            if (!v.ok) {
+                std::cerr << "Verification FAILED: " << mode << " job " << i << " (n=" << sizes[i]
+                          << "), row " << v.row << "\n";
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<double> blockingReady(sizes.size()), asyncReady(sizes.size());
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        int m = sizes[i];
+        gemm<T, Acc>(Trans::No, Trans::No, m, m, m, Acc(1), A[i].data(), A[i].ld(), B[i].data(), B[i].ld(),
+                     Acc(0), C[i].data(), C[i].ld(), GemmAlgo::Auto, opts.threads);
+        blockingReady[i] = since(start);
+    }
+    double blocking_ms = since(start);
+    if (!verify("blocking"))
+        return false;
+
+    std::vector<std::future<void>> futures;
+    std::vector<bool> ready(sizes.size(), false);
+    start = Clock::now();
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        int m = sizes[i];
+        futures.push_back(gemm_async<T, Acc>(Trans::No, Trans::No, m, m, m, Acc(1), A[i].data(), A[i].ld(),
+                                             B[i].data(), B[i].ld(), Acc(0), C[i].data(), C[i].ld()));
+    }
+    // Sleep on the oldest unfinished job, but look at every job when woken, so
+    // each completion time is seen (to 0.1 ms) rather than just the order of waiting.
+    for (std::size_t done = 0; done < futures.size();) {
+        std::size_t oldest = std::find(ready.begin(), ready.end(), false) - ready.begin();
+        futures[oldest].wait_for(std::chrono::microseconds(100));
+        for (std::size_t i = 0; i < futures.size(); ++i) {
+            if (ready[i] || futures[i].wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                continue;
+            futures[i].get();
+            asyncReady[i] = since(start);
+            ready[i] = true;
+            ++done;
+        }
+    }
+    double async_ms = since(start);
+    if (!verify("async"))
+        return false;
+
+    std::cout << "Async: " << n << "^3 product + " << jobs - 1 << " small ones on "
+              << TaskScheduler::instance().worker_count() << " workers\n"
+              << "    blocking, in turn: " << blocking_ms << " ms total, small jobs ready after "
+              << median_of_small(blockingReady) << " ms (median)\n"
+              << "    gemm_async:        " << async_ms << " ms total, small jobs ready after "
+              << median_of_small(asyncReady) << " ms (median)\n";
+    std::ofstream csv("async.csv");
+    csv << "Job,Size,BlockingReadyMs,AsyncReadyMs\n";
+    for (std::size_t i = 0; i < sizes.size(); ++i)
+        csv << i << "," << sizes[i] << "," << blockingReady[i] << "," << asyncReady[i] << "\n";
+    std::cout << "Async CSV written to async.csv\n";
+    return true;
+}
+
+/**
+ * Out-of-core C = A * B of n x n matrix files in `dir` with at most
+ * budgetMiB of buffers, then the I/O the run needed and how much of it the
+ * read-ahead / write-behind hid behind compute. With --verify the product is
+ * checked through the mappings. Refuses to run if any of the three files
+ * already exists; the ones it wrote are removed afterwards.
+ */
+template <typename T, typename Acc>
+static bool run_out_of_core(const BenchOptions& opts, int n, int budgetMiB, const std::filesystem::path& dir)
+{
+    const std::string pathA = (dir / "camm_ooc_A.bin").string();
+    const std::string pathB = (dir / "camm_ooc_B.bin").string();
+    const std::string pathC = (dir / "camm_ooc_C.bin").string();
+    for (const std::string& path : { pathA, pathB, pathC }) {
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec) || ec) {
+            std::cerr << "Out-of-core: " << path << " already exists; not overwriting it\n";
+            return false;
+        }
+    }
+    // Small values, so no sum of n products can overflow Acc.
+    auto values = [n](int salt) {
+        return [n, salt](std::int64_t i, T* row) {
+            for (int j = 0; j < n; ++j)
+                row[j] = static_cast<T>((i * 131 + j * 71 + salt) % 7 - 3);
+        };
+    };
+    std::string error;
+    bool ok = write_matrix_file<T>(pathA, n, n, values(1), &error)
+              && write_matrix_file<T>(pathB, n, n, values(2), &error);
+
+    OutOfCoreOptions options;
+    options.memory_budget = std::size_t(budgetMiB) << 20;
+    options.threadCount = opts.threads;
+    OutOfCoreStats stats;
+    ok = ok && out_of_core_matmul<T, Acc>(pathA, pathB, pathC, options, &stats, &error);
+    if (!ok)
+        std::cerr << "Out-of-core matmul failed: " << error << "\n";
+
+    if (ok) {
+        std::cout << "Out-of-core " << n << "x" << n << " (" << budgetMiB << " MiB budget, "
+                  << stats.block_rows << "x" << stats.block_cols << " C blocks, K panels of "
+                  << stats.panel_depth << ", " << (stats.buffer_bytes >> 20) << " MiB buffers): "
+                  << stats.wall_ms << " ms, " << 2.0 * n * n * n / (stats.wall_ms * 1e6) << " GOP/s\n"
+                  << "    I/O: " << (stats.bytes_read >> 20) << " MiB read, " << (stats.bytes_written >> 20)
+                  << " MiB written in " << stats.io_ms << " ms (" << stats.io_gbs() << " GB/s); compute "
+                  << stats.compute_ms << " ms; waited " << stats.stall_ms << " ms for I/O, "
+                  << 100.0 * stats.hidden_fraction() << "% of I/O hidden\n";
+    }
+
+    if (ok && opts.verifyRounds > 0) {
+        MappedMatrixFile a, b, c;
+        ok = a.open(pathA, false, &error) && b.open(pathB, false, &error) && c.open(pathC, false, &error);
+        VerifyResult v;
+        if (ok)
+            v = freivalds_check<T, Acc>(a.view<const T>(), b.view<const T>(), c.view<const Acc>(),
+                                        opts.verifyRounds, VERIFY_SEED);
+        if (!ok || !v.ok) {
+            std::cerr << "Verification FAILED: out-of-core at n=" << n << ", row " << v.row << " " << error << "\n";
+            ok = false;
+        }
+    }
+
+    for (const std::string& path : { pathA, pathB, pathC }) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return ok;
+}
+
+// Fastest of `reps` runs of fn in milliseconds; C is cleared before each run.
+template <typename Acc, typename Fn>
+static double best_ms(int reps, Matrix<Acc>& C, Fn&& fn)
+{
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        C.zero();
+        auto start = Clock::now();
+        fn();
+        auto end = Clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// Times fn(candidate) for every candidate, stores the fastest under key for
+// the class and prints it.
+template <typename Acc, typename Fn>
+static int tune_one(TuneKey key, DType dtype, ShapeClass cls, const std::vector<int>& candidates,
+                    Matrix<Acc>& C, Fn&& fn)
+{
+    int best = candidates.front();
+    double bestMs = 1e300;
+    for (int candidate : candidates) {
+        double ms = best_ms(2, C, [&] { fn(candidate); });
+        if (ms < bestMs) {
+            bestMs = ms;
+            best = candidate;
+        }
+    }
+    set_tuned_value(key, dtype, cls, best);
+    std::cout << "  " << tune_key_name(key) << " " << shape_class_name(cls) << ": " << best
+              << " (" << bestMs << " ms)\n";
+    return best;
+}
+
+/**
+ * Searches tile edges, recursion cutoffs and task counts for one representative
+ * square size per shape class, then the Strassen crossover, and writes the
+ * winners for this CPU model to the tuning file. Values of other dtypes and
+ * other CPU models already in the file are kept.
+ */
+template <typename T, typename Acc>
+static bool run_tuning(int cacheLine, int l1Cache)
+{
+    constexpr DType dtype = dtype_of<T, Acc>();
+    int workers = TaskScheduler::instance().worker_count();
+
+    std::vector<int> threadCounts = { 1, 2, 4, 8, workers, 2 * workers };
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+
+    std::cout << "Tuning " << dtype_name(dtype) << " for " << cpu_model_name() << "\n";
+    for (int n : { 128, 512, 1280 }) {
+        ShapeClass cls = shape_class(n, n, n);
+        Matrix<T>   A(n, n, T(1));
+        Matrix<T>   B(n, n, T(1));
+        Matrix<Acc> C(n, n);
+
+        tune_one(TuneKey::CacheAwareBlock, dtype, cls, { 16, 32, 48, 64, 96, 128, 256 }, C, [&](int b) {
+            cache_aware_matmul<T, Acc>(A, B, C, cacheLine, l1Cache, b);
+        });
+        tune_one(TuneKey::ObliviousCutoff, dtype, cls, { 16, 32, 64, 128, 256 }, C, [&](int cutoff) {
+            cache_oblivious_matmul<T, Acc>(A, B, C, cutoff);
+        });
+        int tile = tune_one(TuneKey::Tile1D, dtype, cls, { 32, 64, 128, 256 }, C, [&](int t) {
+            cache_aware_matmul_1D<T, Acc>(A, B, C, workers, TileOrder::Morton, t);
+        });
+        tune_one(TuneKey::Threads1D, dtype, cls, threadCounts, C, [&](int threads) {
+            cache_aware_matmul_1D<T, Acc>(A, B, C, threads, TileOrder::Morton, tile);
+        });
+        tune_one(TuneKey::PackedThreads, dtype, cls, threadCounts, C, [&](int threads) {
+            packed_matmul<T, Acc>(A, B, C, threads);
+        });
+    }
+
+    int threads = tuned_value(TuneKey::PackedThreads, dtype, ShapeClass::Large, workers);
+    std::cout << "  " << tune_key_name(TuneKey::StrassenCrossover) << ": "
+              << tune_strassen_crossover<T, Acc>(threads) << "\n";
+
+    std::string path = tuning_file_path();
+    if (!save_tuning_file(path)) {
+        std::cerr << "Could not write tuning file " << path << "\n";
+        return false;
+    }
+    std::cout << "Tuning written to " << path << "\n";
+    return true;
+}
+
+// "start:end:step", "start:end" (step 1) or a single size.
+static bool parse_sizes(const std::string& text, BenchOptions& opts)
+{
+    std::vector<int> parts;
+    std::size_t begin = 0;
+    try {
+        while (true) {
+            std::size_t colon = text.find(':', begin);
+            parts.push_back(std::stoi(text.substr(begin, colon - begin)));
+            if (colon == std::string::npos)
+                break;
+            begin = colon + 1;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (parts.size() > 3 || parts[0] < 1)
+        return false;
+    opts.sweepStart = parts[0];
+    opts.sweepEnd = parts.size() > 1 ? parts[1] : parts[0];
+    opts.sweepStep = parts.size() > 2 ? parts[2] : 1;
+    return opts.sweepEnd >= opts.sweepStart && opts.sweepStep >= 1;
+}
+
+// Comma- or space-separated names from ALGORITHMS, or "all".
+static bool parse_algos(const std::vector<std::string>& words, BenchOptions& opts)
+{
+    std::vector<bool> selected(std::size(ALGORITHMS), false);
+    for (const std::string& word : words) {
+        std::size_t begin = 0;
+        while (begin <= word.size()) {
+            std::size_t comma = std::min(word.find(',', begin), word.size());
+            std::string name = word.substr(begin, comma - begin);
+            begin = comma + 1;
+            if (name.empty())
+                continue;
+            bool known = false;
+            for (const AlgoInfo& info : ALGORITHMS) {
+                if (name == "all" || name == info.flag) {
+                    selected[static_cast<int>(info.algo)] = true;
+                    known = true;
+                }
+            }
+            if (!known)
+                return false;
+        }
+    }
+    opts.algos.clear();
+    for (const AlgoInfo& info : ALGORITHMS)
+        if (selected[static_cast<int>(info.algo)])
+            opts.algos.push_back(info.algo);
+    return !opts.algos.empty();
+}
+
+// A non-negative integer option (at least `minimum`); false if malformed.
+static bool parse_count(const zen::cmd_args& args, const char* flag, int minimum, int& out)
+{
+    auto opts = args.get_options(flag);
+    try {
+        if (opts.empty() || std::stoi(opts[0]) < minimum)
+            return false;
+        out = std::stoi(opts[0]);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
 int main(int argc, char* argv[]) {
     zen::cmd_args args(argv, argc);
     
     int size = DEFAULT_SIZE;
-    if (args.is_present("--size")) {
-        size = std::stoi(args.get_options("--size")[0]);
+    if (args.is_present("--size") && !parse_count(args, "--size", 1, size)) {
+        std::cerr << "--size expects a positive matrix size\n";
+        return 1;
     }
+
+    // SIMD kernels are picked by CPUID; --isa forces a narrower one for A/B runs.
+    if (args.is_present("--isa")) {
+        auto opts = args.get_options("--isa");
+        Isa requested;
+        if (opts.empty() || !parse_isa(opts[0], requested)) {
+            std::cerr << "Unknown --isa value (expected scalar, sse4.1, avx2 or avx512)\n";
+            return 1;
+        }
+        if (!set_active_isa(requested)) {
+            std::cerr << "--isa " << isa_name(requested) << " is not supported on this CPU\n";
+            return 1;
+        }
+    }
+    std::cout << "SIMD kernels: " << isa_name(active_isa())
+              << " (widest supported: " << isa_name(detect_isa()) << ")\n";
     
     // Determine cache parameters
     int cacheLine = static_cast<int>(get_cache_line_size());
@@ -27,139 +1107,227 @@ int main(int argc, char* argv[]) {
     std::cout << "Detected Cache Line Size: " << cacheLine << " bytes\n";
     std::cout << "Detected L1 Cache Size:   " << l1Cache  << " bytes\n";
 
-    //--------------------------------------------------------------------------
-    // 1) Benchmark (vector-of-vectors) for naive, cache-aware, cache-oblivious
-    //--------------------------------------------------------------------------
-    std::vector<std::vector<int>> A(size, std::vector<int>(size, 1));
-    std::vector<std::vector<int>> B(size, std::vector<int>(size, 1));
-    std::vector<std::vector<int>> C(size, std::vector<int>(size, 0));
-
-    // ---------------- Naive ----------------
-    auto startNaive = Clock::now();
-    naive_matmul(A, B, C);
-    auto endNaive   = Clock::now();
-    std::cout << "Naive matmul time: "
-              << std::chrono::duration<double, std::milli>(endNaive - startNaive).count()
-              << " ms\n";
-
-    // ---------------- Cache-Aware (vec-of-vec) ----------------
-    std::fill(C.begin(), C.end(), std::vector<int>(size, 0));
-    auto startAware = Clock::now();
-    cache_aware_matmul(A, B, C, cacheLine, l1Cache);
-    auto endAware   = Clock::now();
-    std::cout << "Cache-aware matmul time: "
-              << std::chrono::duration<double, std::milli>(endAware - startAware).count()
-              << " ms\n";
-
-    // ---------------- Cache-Oblivious (vec-of-vec) ----------------
-    std::fill(C.begin(), C.end(), std::vector<int>(size, 0));
-    auto startObliv = Clock::now();
-    cache_oblivious_matmul(A, B, C);
-    auto endObliv   = Clock::now();
-    std::cout << "Cache-oblivious matmul time: "
-              << std::chrono::duration<double, std::milli>(endObliv - startObliv).count()
-              << " ms\n";
+    const SystemTopology& topo = system_topology();
+    std::cout << "CPUs: " << topo.cpus.size() << " logical, " << topo.physical_cores() << " cores, "
+              << topo.packages() << " packages\n";
+    for (const CacheInfo& cache : topo.caches) {
+        const char* kind = cache.type == CacheType::Data ? "d"
+                         : cache.type == CacheType::Instruction ? "i" : "";
+        std::cout << "  L" << cache.level << kind << ": " << (cache.size >> 10) << " KiB, "
+                  << cache.ways << "-way, " << cache.line_size << " B lines, shared by "
+                  << cache.shared_cpus.size() << " CPU(s)\n";
+    }
 
-    //--------------------------------------------------------------------------
-    // 2) Benchmark the 1D-Aligned approach with std::thread
-    //--------------------------------------------------------------------------
-    {
-        int n = size; 
-        int threadCount = 8; 
-
-        int* A_ = allocate_aligned_matrix(n);
-        int* B_ = allocate_aligned_matrix(n);
-        int* C_ = allocate_aligned_matrix(n);
-
-        // Initialize data
-        for (int i = 0; i < n; i++){
-            for (int j = 0; j < n; j++){
-                mat_elem(A_, n, i, j) = 1;
-                mat_elem(B_, n, i, j) = 1;
-                mat_elem(C_, n, i, j) = 0;
-            }
+    DType dtype = DType::I32;
+    if (args.is_present("--dtype")) {
+        auto opts = args.get_options("--dtype");
+        if (opts.empty() || !parse_dtype(opts[0], dtype)) {
+            std::cerr << "Unknown --dtype value (expected f32, f64, i8, i16, i32 or i64)\n";
+            return 1;
         }
+    }
+    std::cout << "Element type: " << dtype_name(dtype) << "\n";
 
-        auto start_1D = Clock::now();
-        cache_aware_matmul_1D(A_, B_, C_, n, threadCount);
-        auto end_1D = Clock::now();
+    // Which algorithms run, how often, on how many tasks and over which sizes.
+    BenchOptions bench;
+    for (const AlgoInfo& info : ALGORITHMS)
+        bench.algos.push_back(info.algo);
+    if (args.is_present("--algos") && !parse_algos(args.get_options("--algos"), bench)) {
+        std::cerr << "Unknown --algos value (expected a comma-separated list of all";
+        for (const AlgoInfo& info : ALGORITHMS)
+            std::cerr << ", " << info.flag;
+        std::cerr << ")\n";
+        return 1;
+    }
+    if (args.is_present("--iterations") && !parse_count(args, "--iterations", 1, bench.plan.iterations)) {
+        std::cerr << "--iterations expects a positive repetition count\n";
+        return 1;
+    }
+    if (args.is_present("--warmup") && !parse_count(args, "--warmup", 0, bench.plan.warmup)) {
+        std::cerr << "--warmup expects a non-negative run count\n";
+        return 1;
+    }
+    if (args.is_present("--threads") && !parse_count(args, "--threads", 1, bench.threads)) {
+        std::cerr << "--threads expects a positive task count\n";
+        return 1;
+    }
+    if (args.is_present("--sizes")) {
+        auto opts = args.get_options("--sizes");
+        if (opts.empty() || !parse_sizes(opts[0], bench)) {
+            std::cerr << "--sizes expects start:end:step (or start:end, or one size)\n";
+            return 1;
+        }
+    }
+    // --verify [rounds]: random inputs and a Freivalds check after every timed run.
+    if (args.is_present("--verify")) {
+        bench.verifyRounds = 3;
+        if (!args.get_options("--verify").empty()
+            && !parse_count(args, "--verify", 1, bench.verifyRounds)) {
+            std::cerr << "--verify expects a positive number of rounds\n";
+            return 1;
+        }
+    }
+    const int fixedTasks = bench.threads > 0 ? bench.threads : 8;
 
-        double elapsed_ms = std::chrono::duration<double,std::milli>(end_1D - start_1D).count();
-        std::cout << "1D matmul (std::thread, " << threadCount 
-                  << " threads) took " << elapsed_ms << " ms.\n";
+    // Back large matrices with 2 MiB pages (Linux; ignored elsewhere).
+    if (args.is_present("--hugepages"))
+        set_huge_pages(true);
 
-        free_aligned_matrix(A_);
-        free_aligned_matrix(B_);
-        free_aligned_matrix(C_);
+    // Size of the persistent worker pool (default: one per hardware thread).
+    int workers = 0;
+    if (args.is_present("--workers") && !parse_count(args, "--workers", 1, workers)) {
+        std::cerr << "--workers expects a positive thread count\n";
+        return 1;
     }
 
-    //--------------------------------------------------------------------------
-    // 3) Benchmark all approaches for a range of sizes [1012..1036], write CSV
-    //--------------------------------------------------------------------------
-    std::ofstream csv("results.csv");
-    csv << "Size,Naive,CacheAware,CacheOblivious,CacheAware1D\n";
-
-    for (int test_size = 1012; test_size <= 1036; ++test_size) {
-        // --- (A) Prepare data for the 3 existing (vector-of-vector) approaches ---
-        std::vector<std::vector<int>> A2(test_size, std::vector<int>(test_size, 1));
-        std::vector<std::vector<int>> B2(test_size, std::vector<int>(test_size, 1));
-        std::vector<std::vector<int>> C2(test_size, std::vector<int>(test_size, 0));
-
-        int cacheLineLocal = get_cache_line_size();
-        int l1CacheLocal   = get_l1_cache_size();
-
-        // (A) Naive
-        auto startA = Clock::now();
-        naive_matmul(A2, B2, C2);
-        auto endA   = Clock::now();
-        double naive_time = std::chrono::duration<double,std::milli>(endA - startA).count();
-
-        // (B) Cache-Aware (vec-of-vec)
-        for (auto &row : C2) std::fill(row.begin(), row.end(), 0);
-        startA = Clock::now();
-        cache_aware_matmul(A2, B2, C2, cacheLineLocal, l1CacheLocal);
-        endA   = Clock::now();
-        double cache_aware_time = std::chrono::duration<double,std::milli>(endA - startA).count();
-
-        // (C) Cache-Oblivious (vec-of-vec)
-        for (auto &row : C2) std::fill(row.begin(), row.end(), 0);
-        startA = Clock::now();
-        cache_oblivious_matmul(A2, B2, C2);
-        endA   = Clock::now();
-        double cache_oblivious_time = std::chrono::duration<double,std::milli>(endA - startA).count();
-
-        // --- (D) 1D approach ---
-        int* A1 = allocate_aligned_matrix(test_size);
-        int* B1 = allocate_aligned_matrix(test_size);
-        int* C1 = allocate_aligned_matrix(test_size);
-
-        for (int i = 0; i < test_size; i++){
-            for (int j = 0; j < test_size; j++){
-                mat_elem(A1,test_size,i,j) = 1;
-                mat_elem(B1,test_size,i,j) = 1;
-                mat_elem(C1,test_size,i,j) = 0;
-            }
+    // Worker placement, read from the /sys CPU topology (Linux only).
+    Affinity affinity = Affinity::None;
+    if (args.is_present("--affinity")) {
+        auto opts = args.get_options("--affinity");
+        if (opts.empty() || !parse_affinity(opts[0], affinity)) {
+            std::cerr << "Unknown --affinity value (expected compact, scatter or none)\n";
+            return 1;
         }
+    }
+    TaskScheduler::configure(workers, affinity);
+    {
+        TaskScheduler& pool = TaskScheduler::instance();
+        std::cout << "Thread pool: " << pool.worker_count() << " workers, affinity "
+                  << affinity_name(pool.affinity()) << " (" << pool.pinned_workers() << " pinned)\n";
+    }
 
-        startA = Clock::now();
-        cache_aware_matmul_1D(A1, B1, C1, test_size, 8);
-        endA   = Clock::now();
-        double cache_aware_1D_time = std::chrono::duration<double,std::milli>(endA - startA).count();
+    // Counters are attached to the threads that exist now, so after the pool starts.
+    std::string perfReason;
+    if (perf_counters_available(&perfReason))
+        std::cout << "Hardware counters: " << PerfCounters().available_events() << " of "
+                  << PERF_EVENT_COUNT << " events available\n";
+    else
+        std::cout << "Hardware counters: unavailable, timing only: " << perfReason << "\n";
 
-        free_aligned_matrix(A1);
-        free_aligned_matrix(B1);
-        free_aligned_matrix(C1);
+    // Block sizes, cutoffs and task counts come from the tuning file when it has
+    // a section for this CPU; --tune measures and writes them.
+    if (args.is_present("--tune")) {
+        bool ok = true;
+        visit_dtype(dtype, [&](auto t, auto acc) {
+            ok = run_tuning<decltype(t), decltype(acc)>(cacheLine, l1Cache);
+        });
+        return ok ? 0 : 1;
+    }
+    std::cout << "Tuning: " << tuned_value_count() << " tuned parameters for " << cpu_model_name()
+              << " (" << tuning_file_path() << ")\n";
+
+    // Measure the Strassen crossover for this machine instead of using the default.
+    if (args.is_present("--strassen-tune")) {
+        visit_dtype(dtype, [&](auto t, auto acc) {
+            int crossover = tune_strassen_crossover<decltype(t), decltype(acc)>(fixedTasks);
+            std::cout << "Tuned Strassen crossover: " << crossover << "\n";
+        });
+    }
 
-        // Write one CSV row
-        csv << test_size << ","
-            << naive_time << ","
-            << cache_aware_time << ","
-            << cache_oblivious_time << ","
-            << cache_aware_1D_time << "\n";
+    if (args.is_present("--pool-latency")) {
+        visit_dtype(dtype, [&](auto t, auto acc) {
+            run_pool_latency<decltype(t), decltype(acc)>(fixedTasks);
+        });
+        return 0;
+    }
+
+    // --batched [count]: matrices per second of the batched small-matrix API.
+    if (args.is_present("--batched")) {
+        int batch = 0;
+        if (!args.get_options("--batched").empty() && !parse_count(args, "--batched", 1, batch)) {
+            std::cerr << "--batched expects a positive number of matrices\n";
+            return 1;
+        }
+        bool ok = true;
+        visit_dtype(dtype, [&](auto t, auto acc) {
+            ok = run_batched<decltype(t), decltype(acc)>(bench, batch);
+        });
+        return ok ? 0 : 1;
     }
 
-    csv.close();
-    std::cout << "Results CSV written to results.csv\n";
+    // --out-of-core [MiB]: --size product of matrix files through a bounded memory budget.
+    // The files go to --ooc-dir DIR, or to a fresh directory under the system temp directory.
+    if (args.is_present("--out-of-core")) {
+        int budgetMiB = 256;
+        if (!args.get_options("--out-of-core").empty() && !parse_count(args, "--out-of-core", 1, budgetMiB)) {
+            std::cerr << "--out-of-core expects a memory budget in MiB\n";
+            return 1;
+        }
+        std::filesystem::path dir;
+        bool ownDir = false;
+        std::error_code ec;
+        if (args.is_present("--ooc-dir")) {
+            auto opts = args.get_options("--ooc-dir");
+            if (opts.empty() || !std::filesystem::is_directory(opts[0], ec)) {
+                std::cerr << "--ooc-dir expects an existing directory\n";
+                return 1;
+            }
+            dir = opts[0];
+        } else {
+            auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            dir = std::filesystem::temp_directory_path(ec) / ("camm_ooc_" + std::to_string(stamp));
+            if (ec || !std::filesystem::create_directory(dir, ec)) {
+                std::cerr << "Out-of-core: cannot create a directory under the temp directory; use --ooc-dir\n";
+                return 1;
+            }
+            ownDir = true;
+        }
+        std::cout << "Out-of-core matrix files in " << dir.string() << "\n";
+        bool ok = true;
+        visit_dtype(dtype, [&](auto t, auto acc) {
+            ok = run_out_of_core<decltype(t), decltype(acc)>(bench, size, budgetMiB, dir);
+        });
+        if (ownDir)
+            std::filesystem::remove(dir, ec);
+        return ok ? 0 : 1;
+    }
+
+    // --async [jobs]: one --size product and jobs - 1 small ones, blocking vs gemm_async.
+    if (args.is_present("--async")) {
+        int jobs = 16;
+        if (!args.get_options("--async").empty() && !parse_count(args, "--async", 1, jobs)) {
+            std::cerr << "--async expects a positive number of jobs\n";
+            return 1;
+        }
+        bool ok = true;
+        visit_dtype(dtype, [&](auto t, auto acc) {
+            ok = run_async<decltype(t), decltype(acc)>(bench, size, jobs);
+        });
+        return ok ? 0 : 1;
+    }
+
+    if (args.is_present("--oblivious-sweep")) {
+        bool ok = true;
+        visit_dtype(dtype, [&](auto t, auto acc) {
+            ok = run_oblivious_sweep<decltype(t), decltype(acc)>();
+        });
+        return ok ? 0 : 1;
+    }
+
+    bool verified = true;
+    visit_dtype(dtype, [&](auto t, auto acc) {
+        using T = decltype(t);
+        using Acc = decltype(acc);
+        // Ceilings for the roofline, measured on the whole pool.
+        int tasks = TaskScheduler::instance().worker_count();
+        MachineCeilings roof;
+        roof.peak_gops = measure_peak_gops<T, Acc>(tasks);
+        roof.bandwidth_gbs = measure_stream_bandwidth(tasks);
+        std::cout << "Compute roof: " << roof.peak_gops << " GOP/s (" << PACK_MR << "x" << PACK_NR
+                  << " " << dtype_name(dtype) << " microkernel on L1-resident panels, " << tasks
+                  << " tasks)\n";
+        std::cout << "Memory roof:  " << roof.bandwidth_gbs << " GB/s (STREAM triad, " << tasks
+                  << " tasks)\n";
+        verified = run_benchmarks<T, Acc>(size, cacheLine, l1Cache, bench, roof);
+    });
+    if (!verified)
+        return 1;
+    std::cout << "Results CSV written to results.csv (statistics in results_summary.csv, "
+                 "every repetition in results_samples.csv)\n";
+
+    BufferPoolStats pool = buffer_pool_stats();
+    std::cout << "Buffer pool: " << pool.hits << " hits, " << pool.misses << " misses, "
+              << (pool.cached_bytes >> 20) << " MiB cached\n";
 
     return 0;
 }
@@ -0,0 +1,81 @@
+#ifndef MATMUL_TYPES_H
+#define MATMUL_TYPES_H
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Input / accumulator type combinations that every algorithm is explicitly
+// instantiated for. X(T, Acc) is expanded once per pair.
+//   f32: float  -> float       i8:  int8_t  -> int32_t
+//   f64: double -> double      i16: int16_t -> int32_t
+//   i32: int32_t -> int32_t    i64: int32_t -> int64_t (no overflow on large counts)
+#define CAMM_FOR_EACH_TYPE_PAIR(X)      \
+    X(float,        float)              \
+    X(double,       double)             \
+    X(std::int8_t,  std::int32_t)       \
+    X(std::int16_t, std::int32_t)       \
+    X(std::int32_t, std::int32_t)       \
+    X(std::int32_t, std::int64_t)
+
+enum class DType {
+    F32,
+    F64,
+    I8,
+    I16,
+    I32,
+    I64
+};
+
+inline const char* dtype_name(DType dtype)
+{
+    switch (dtype) {
+        case DType::F32: return "f32";
+        case DType::F64: return "f64";
+        case DType::I8:  return "i8";
+        case DType::I16: return "i16";
+        case DType::I32: return "i32";
+        case DType::I64: return "i64";
+    }
+    return "unknown";
+}
+
+inline bool parse_dtype(const std::string& name, DType& out)
+{
+    if (name == "f32" || name == "float")  { out = DType::F32; return true; }
+    if (name == "f64" || name == "double") { out = DType::F64; return true; }
+    if (name == "i8")                      { out = DType::I8;  return true; }
+    if (name == "i16")                     { out = DType::I16; return true; }
+    if (name == "i32" || name == "int")    { out = DType::I32; return true; }
+    if (name == "i64")                     { out = DType::I64; return true; }
+    return false;
+}
+
+// Calls f(T{}, Acc{}) with the type pair that belongs to dtype.
+template <typename F>
+void visit_dtype(DType dtype, F&& f)
+{
+    switch (dtype) {
+        case DType::F32: f(float{},        float{});        break;
+        case DType::F64: f(double{},       double{});       break;
+        case DType::I8:  f(std::int8_t{},  std::int32_t{}); break;
+        case DType::I16: f(std::int16_t{}, std::int32_t{}); break;
+        case DType::I32: f(std::int32_t{}, std::int32_t{}); break;
+        case DType::I64: f(std::int32_t{}, std::int64_t{}); break;
+    }
+}
+
+// The DType of a type pair (the inverse of visit_dtype). Int64 x int64, only
+// used inside Strassen, maps to I64 as well.
+template <typename T, typename Acc>
+constexpr DType dtype_of()
+{
+    if (std::is_same<T, float>::value)        return DType::F32;
+    if (std::is_same<T, double>::value)       return DType::F64;
+    if (std::is_same<T, std::int8_t>::value)  return DType::I8;
+    if (std::is_same<T, std::int16_t>::value) return DType::I16;
+    if (std::is_same<Acc, std::int64_t>::value) return DType::I64;
+    return DType::I32;
+}
+
+#endif // MATMUL_TYPES_H
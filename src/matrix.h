@@ -0,0 +1,144 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include "buffer_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// Non-owning, row-major view of a rows x cols block whose rows are ld elements
+// apart. Copying a view is free; sub-blocks share the parent's storage.
+// MatrixView<const T> is the read-only flavour (implicitly made from MatrixView<T>).
+template <typename T>
+class MatrixView {
+public:
+    MatrixView() = default;
+
+    MatrixView(T* data, int rows, int cols, int ld)
+        : data_(data), rows_(rows), cols_(cols), ld_(ld) {}
+
+    template <typename U,
+              typename = std::enable_if_t<std::is_same<const U, T>::value>>
+    MatrixView(const MatrixView<U>& other)
+        : data_(other.data()), rows_(other.rows()), cols_(other.cols()), ld_(other.ld()) {}
+
+    T*  data() const { return data_; }
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int ld()   const { return ld_; }
+    bool empty() const { return rows_ <= 0 || cols_ <= 0; }
+
+    T* row(int i) const { return data_ + static_cast<std::ptrdiff_t>(i) * ld_; }
+    T& operator()(int i, int j) const { return row(i)[j]; }
+
+    // rows x cols sub-block starting at (r0, c0); no bounds checks, like operator().
+    MatrixView block(int r0, int c0, int rows, int cols) const {
+        return MatrixView(row(r0) + c0, rows, cols, ld_);
+    }
+
+private:
+    T*  data_ = nullptr;
+    int rows_ = 0;
+    int cols_ = 0;
+    int ld_   = 0;
+};
+
+// Leading dimension for a row of `cols` elements: rounded up to a whole 64-byte
+// cache line so every row starts aligned, plus one extra line when the stride
+// would be a multiple of 4 KiB (rows that alias in the same cache sets).
+template <typename T>
+int padded_ld(int cols) {
+    constexpr int line = static_cast<int>(64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1);
+    int ld = (cols + line - 1) / line * line;
+    if (ld > line && (static_cast<std::size_t>(ld) * sizeof(T)) % 4096 == 0)
+        ld += line;
+    return ld;
+}
+
+// Owning, move-only, 64-byte aligned matrix. Rows are padded_ld(cols) apart,
+// so every row is cache-line aligned; the storage is still one contiguous block.
+// Storage comes from the buffer pool (acquire_buffer) and starts zeroed
+// unless constructed Uninitialized or from a fill value;
+// destroying the matrix hands it back for the next matrix of a similar size.
+template <typename T>
+class Matrix {
+public:
+    // Tag for storage the caller overwrites completely: not zeroed first.
+    struct Uninitialized {};
+
+    Matrix() = default;
+
+    Matrix(int rows, int cols)
+        : rows_(rows), cols_(cols), ld_(padded_ld<T>(cols)) { allocate(true); }
+
+    Matrix(int rows, int cols, Uninitialized)
+        : rows_(rows), cols_(cols), ld_(padded_ld<T>(cols)) { allocate(false); }
+
+    // Every element is written by fill, so the storage is not zeroed first.
+    Matrix(int rows, int cols, T value)
+        : Matrix(rows, cols, Uninitialized{})
+    {
+        fill(value);
+    }
+
+    Matrix(const Matrix&) = delete;
+    Matrix& operator=(const Matrix&) = delete;
+
+    Matrix(Matrix&& other) noexcept { swap(other); }
+    Matrix& operator=(Matrix&& other) noexcept {
+        Matrix(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~Matrix() { release_buffer(data_); }
+
+    T*       data()       { return data_; }
+    const T* data() const { return data_; }
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int ld()   const { return ld_; }
+    std::size_t size() const { return static_cast<std::size_t>(rows_) * cols_; }
+    // Elements actually allocated, including row padding.
+    std::size_t storage_size() const { return static_cast<std::size_t>(rows_) * ld_; }
+
+    T&       operator()(int i, int j)       { return data_[static_cast<std::size_t>(i) * ld_ + j]; }
+    const T& operator()(int i, int j) const { return data_[static_cast<std::size_t>(i) * ld_ + j]; }
+
+    MatrixView<T>       view()       { return MatrixView<T>(data_, rows_, cols_, ld_); }
+    MatrixView<const T> view() const { return MatrixView<const T>(data_, rows_, cols_, ld_); }
+    operator MatrixView<T>()             { return view(); }
+    operator MatrixView<const T>() const { return view(); }
+
+    // Resets every element with a single memset over the contiguous storage.
+    void zero() {
+        if (data_)
+            std::memset(data_, 0, storage_size() * sizeof(T));
+    }
+
+    // Padding is filled too; it is never read by the kernels.
+    void fill(T value) { std::fill(data_, data_ + storage_size(), value); }
+
+    void swap(Matrix& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(rows_, other.rows_);
+        std::swap(cols_, other.cols_);
+        std::swap(ld_, other.ld_);
+    }
+
+private:
+    void allocate(bool zeroed)
+    {
+        if (storage_size() > 0)
+            data_ = static_cast<T*>(acquire_buffer(storage_size() * sizeof(T), zeroed));
+    }
+
+    T*  data_ = nullptr;
+    int rows_ = 0;
+    int cols_ = 0;
+    int ld_   = 0;
+};
+
+#endif // MATRIX_H
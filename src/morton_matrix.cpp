@@ -0,0 +1,145 @@
+#include "morton_matrix.h"
+#include "simd_kernels.h"
+#include "matmul_types.h"
+
+#include <algorithm>
+
+template <typename T>
+void to_morton(MatrixView<const T> src, MortonMatrix<T>& dst)
+{
+    const int grid = dst.grid();
+    for (int ti = 0; ti < grid; ++ti) {
+        for (int tj = 0; tj < grid; ++tj) {
+            T* tile = dst.tile(ti, tj);
+            int c0 = tj * MORTON_TILE;
+            int width = std::clamp(src.cols() - c0, 0, MORTON_TILE);
+
+            for (int r = 0; r < MORTON_TILE; ++r) {
+                T* out = tile + r * MORTON_TILE;
+                int row = ti * MORTON_TILE + r;
+                if (row < src.rows() && width > 0) {
+                    const T* in = src.row(row) + c0;
+                    std::copy(in, in + width, out);
+                    std::fill(out + width, out + MORTON_TILE, T(0));
+                } else {
+                    std::fill(out, out + MORTON_TILE, T(0));
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void from_morton(const MortonMatrix<T>& src, MatrixView<T> dst)
+{
+    int tilesM = (dst.rows() + MORTON_TILE - 1) / MORTON_TILE;
+    int tilesN = (dst.cols() + MORTON_TILE - 1) / MORTON_TILE;
+    for (int ti = 0; ti < tilesM; ++ti) {
+        for (int tj = 0; tj < tilesN; ++tj) {
+            const T* tile = src.tile(ti, tj);
+            int c0 = tj * MORTON_TILE;
+            int width = std::min(MORTON_TILE, dst.cols() - c0);
+            int height = std::min(MORTON_TILE, dst.rows() - ti * MORTON_TILE);
+
+            for (int r = 0; r < height; ++r) {
+                const T* in = tile + r * MORTON_TILE;
+                std::copy(in, in + width, dst.row(ti * MORTON_TILE + r) + c0);
+            }
+        }
+    }
+}
+
+namespace {
+
+// Extent of the real (non-padding) data, in tiles.
+struct TileExtent {
+    int m;
+    int k;
+    int n;
+};
+
+// One MORTON_TILE^3 product on row-major tiles.
+template <typename T, typename Acc>
+void tile_multiply(const T* A, const T* B, Acc* C)
+{
+    const auto axpy = simd_kernels<T, Acc>().axpy;
+    for (int i = 0; i < MORTON_TILE; ++i)
+        for (int k = 0; k < MORTON_TILE; ++k)
+            axpy(C + i * MORTON_TILE, B + k * MORTON_TILE,
+                 static_cast<Acc>(A[i * MORTON_TILE + k]), MORTON_TILE);
+}
+
+/**
+ * Same 8-product recursion as matmul_recursive, but a quadrant is just an
+ * offset into the Z-ordered storage: quadrant q of a side x side block starts
+ * q * (side/2)^2 tiles in. (i0, k0, j0) track the tile position so blocks that
+ * lie entirely in the zero padding are skipped.
+ */
+template <typename T, typename Acc>
+void morton_recursive(const T* A, const T* B, Acc* C, int side,
+                      int i0, int k0, int j0, const TileExtent& extent)
+{
+    if (i0 >= extent.m || k0 >= extent.k || j0 >= extent.n)
+        return;
+
+    if (side == 1) {
+        tile_multiply(A, B, C);
+        return;
+    }
+
+    int h = side / 2;
+    std::size_t q = static_cast<std::size_t>(h) * h * MortonMatrix<T>::TILE_ELEMS;
+    std::size_t qc = static_cast<std::size_t>(h) * h * MortonMatrix<Acc>::TILE_ELEMS;
+
+    const T* A11 = A;  const T* A12 = A + q;  const T* A21 = A + 2 * q;  const T* A22 = A + 3 * q;
+    const T* B11 = B;  const T* B12 = B + q;  const T* B21 = B + 2 * q;  const T* B22 = B + 3 * q;
+    Acc* C11 = C;      Acc* C12 = C + qc;     Acc* C21 = C + 2 * qc;     Acc* C22 = C + 3 * qc;
+
+    // C11 = A11*B11 + A12*B21
+    morton_recursive(A11, B11, C11, h, i0,     k0,     j0,     extent);
+    morton_recursive(A12, B21, C11, h, i0,     k0 + h, j0,     extent);
+    // C12 = A11*B12 + A12*B22
+    morton_recursive(A11, B12, C12, h, i0,     k0,     j0 + h, extent);
+    morton_recursive(A12, B22, C12, h, i0,     k0 + h, j0 + h, extent);
+    // C21 = A21*B11 + A22*B21
+    morton_recursive(A21, B11, C21, h, i0 + h, k0,     j0,     extent);
+    morton_recursive(A22, B21, C21, h, i0 + h, k0 + h, j0,     extent);
+    // C22 = A21*B12 + A22*B22
+    morton_recursive(A21, B12, C22, h, i0 + h, k0,     j0 + h, extent);
+    morton_recursive(A22, B22, C22, h, i0 + h, k0 + h, j0 + h, extent);
+}
+
+int tiles_for(int extent)
+{
+    return (extent + MORTON_TILE - 1) / MORTON_TILE;
+}
+
+} // namespace
+
+template <typename T, typename Acc>
+void cache_oblivious_matmul_morton(const MortonMatrix<T>& A, const MortonMatrix<T>& B,
+                                   MortonMatrix<Acc>& C)
+{
+    if (C.grid() == 0 || A.cols() <= 0)
+        return;
+
+    TileExtent extent = { tiles_for(C.rows()), tiles_for(A.cols()), tiles_for(C.cols()) };
+    morton_recursive(A.data(), B.data(), C.data(), C.grid(), 0, 0, 0, extent);
+}
+
+#define CAMM_INSTANTIATE_MORTON(T, Acc)                                                      \
+    template void cache_oblivious_matmul_morton<T, Acc>(const MortonMatrix<T>&,              \
+                                                        const MortonMatrix<T>&,              \
+                                                        MortonMatrix<Acc>&);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_MORTON)
+
+// Layout converters for every element type used as an input or accumulator.
+#define CAMM_INSTANTIATE_MORTON_CONVERT(T)                                   \
+    template void to_morton<T>(MatrixView<const T>, MortonMatrix<T>&);       \
+    template void from_morton<T>(const MortonMatrix<T>&, MatrixView<T>);
+CAMM_INSTANTIATE_MORTON_CONVERT(float)
+CAMM_INSTANTIATE_MORTON_CONVERT(double)
+CAMM_INSTANTIATE_MORTON_CONVERT(std::int8_t)
+CAMM_INSTANTIATE_MORTON_CONVERT(std::int16_t)
+CAMM_INSTANTIATE_MORTON_CONVERT(std::int32_t)
+CAMM_INSTANTIATE_MORTON_CONVERT(std::int64_t)
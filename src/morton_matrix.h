@@ -0,0 +1,106 @@
+#ifndef MORTON_MATRIX_H
+#define MORTON_MATRIX_H
+
+#include "buffer_pool.h"
+#include "matrix.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Edge of one tile in elements. Tiles are stored row-major internally.
+constexpr int MORTON_TILE = 64;
+
+// Z-order index of tile (ti, tj): column bits in the even positions, row bits
+// in the odd ones, so quadrants come out as TL, TR, BL, BR.
+inline std::uint32_t morton_index(std::uint32_t ti, std::uint32_t tj)
+{
+    auto spread = [](std::uint32_t x) {
+        x &= 0xFFFF;
+        x = (x | (x << 8)) & 0x00FF00FF;
+        x = (x | (x << 4)) & 0x0F0F0F0F;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+        return x;
+    };
+    return (spread(ti) << 1) | spread(tj);
+}
+
+// Tiles per side needed so a power-of-two tile grid covers `extent` elements.
+inline int morton_grid_for(int extent)
+{
+    int tiles = (extent + MORTON_TILE - 1) / MORTON_TILE;
+    int grid = 1;
+    while (grid < tiles)
+        grid *= 2;
+    return grid;
+}
+
+// A rows x cols matrix stored as a grid x grid square of MORTON_TILE^2 tiles in
+// Z-order. Every aligned power-of-two block of tiles -- in particular every
+// quadrant at every recursion level -- is one contiguous range of memory.
+// Elements outside rows x cols are zero padding. Move-only, like Matrix<T>.
+template <typename T>
+class MortonMatrix {
+public:
+    static constexpr std::size_t TILE_ELEMS = static_cast<std::size_t>(MORTON_TILE) * MORTON_TILE;
+
+    MortonMatrix() = default;
+
+    MortonMatrix(int rows, int cols, int grid)
+        : rows_(rows), cols_(cols), grid_(grid)
+    {
+        if (storage_size() > 0)
+            data_ = static_cast<T*>(acquire_buffer(storage_size() * sizeof(T)));
+    }
+
+    MortonMatrix(const MortonMatrix&) = delete;
+    MortonMatrix& operator=(const MortonMatrix&) = delete;
+
+    MortonMatrix(MortonMatrix&& other) noexcept { swap(other); }
+    MortonMatrix& operator=(MortonMatrix&& other) noexcept {
+        MortonMatrix(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~MortonMatrix() { release_buffer(data_); }
+
+    T*       data()       { return data_; }
+    const T* data() const { return data_; }
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int grid() const { return grid_; }
+    std::size_t storage_size() const {
+        return static_cast<std::size_t>(grid_) * grid_ * TILE_ELEMS;
+    }
+
+    T*       tile(int ti, int tj)       { return data_ + morton_index(ti, tj) * TILE_ELEMS; }
+    const T* tile(int ti, int tj) const { return data_ + morton_index(ti, tj) * TILE_ELEMS; }
+
+    void swap(MortonMatrix& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(rows_, other.rows_);
+        std::swap(cols_, other.cols_);
+        std::swap(grid_, other.grid_);
+    }
+
+private:
+    T*  data_ = nullptr;
+    int rows_ = 0;
+    int cols_ = 0;
+    int grid_ = 0;
+};
+
+// Row-major -> Morton (padding is zeroed) and back (only rows x cols is written).
+template <typename T>
+void to_morton(MatrixView<const T> src, MortonMatrix<T>& dst);
+template <typename T>
+void from_morton(const MortonMatrix<T>& src, MatrixView<T> dst);
+
+// C += A * B with all three operands in Morton layout on the same tile grid
+// (use morton_grid_for(max(M, K, N))). Recurses over contiguous quadrants.
+template <typename T, typename Acc>
+void cache_oblivious_matmul_morton(const MortonMatrix<T>& A, const MortonMatrix<T>& B,
+                                   MortonMatrix<Acc>& C);
+
+#endif // MORTON_MATRIX_H
@@ -1,11 +1,18 @@
 #include "naive_matmul.h"
+#include "simd_kernels.h"
+#include "matmul_types.h"
 
-void naive_matmul(const std::vector<std::vector<int>>& A,
-                  const std::vector<std::vector<int>>& B,
-                  std::vector<std::vector<int>>& C) {
-    int n = A.size();
-    for (int i = 0; i < n; ++i)
-        for (int k = 0; k < n; ++k)
-            for (int j = 0; j < n; ++j)
-                C[i][j] += A[i][k] * B[k][j];
+template <typename T, typename Acc>
+void naive_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C) {
+    const auto axpy = simd_kernels<T, Acc>().axpy;
+    int M = C.rows(), N = C.cols(), K = A.cols();
+    if (try_fixed_matmul<T, Acc>(M, N, K, A.data(), A.ld(), B.data(), B.ld(), C.data(), C.ld()))
+        return;
+    for (int i = 0; i < M; ++i)
+        for (int k = 0; k < K; ++k)
+            axpy(C.row(i), B.row(k), static_cast<Acc>(A(i, k)), N); // C[i][:] += A[i][k] * B[k][:]
 }
+
+#define CAMM_INSTANTIATE_NAIVE(T, Acc) \
+    template void naive_matmul<T, Acc>(MatrixView<const T>, MatrixView<const T>, MatrixView<Acc>);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_NAIVE)
@@ -1,10 +1,11 @@
 #ifndef NAIVE_MATMUL_H
 #define NAIVE_MATMUL_H
 
-#include <vector>
+#include "matrix.h"
 
-void naive_matmul(const std::vector<std::vector<int>>& A,
-                  const std::vector<std::vector<int>>& B,
-                  std::vector<std::vector<int>>& C);
+// C(MxN) += A(MxK) * B(KxN) with inputs of type T accumulated in Acc
+// (see matmul_types.h). Matrix<T> arguments convert to views implicitly.
+template <typename T, typename Acc>
+void naive_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C);
 
 #endif // NAIVE_MATMUL_H
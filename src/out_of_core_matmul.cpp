@@ -0,0 +1,437 @@
+#include "out_of_core_matmul.h"
+#include "matmul_types.h"
+#include "packed_matmul.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+    #ifndef _WIN32_WINNT
+    #define _WIN32_WINNT 0x0600
+    #endif
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::uint64_t page_size()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// Depth of the A and B panels in packed KC panels: every row copied is then a
+// sequential run of a few KiB, and packed_gemm never gets a short last panel.
+constexpr int PANEL_KC = 2;
+
+struct OutOfCoreBlocking {
+    int mb;
+    int nb;
+    int kb;
+};
+
+// Buffer bytes of a blocking: two A panels, two B panels, two C blocks.
+double buffer_bytes(double mb, double nb, double kb, double sizeT, double sizeAcc)
+{
+    return 2 * (mb * kb + kb * nb) * sizeT + 2 * mb * nb * sizeAcc;
+}
+
+// Edge rounded down to whole PACK_NR columns once it is that wide.
+int round_edge(double edge, std::int64_t extent)
+{
+    std::int64_t e = static_cast<std::int64_t>(edge);
+    if (e >= PACK_NR)
+        e = e / PACK_NR * PACK_NR;
+    return static_cast<int>(std::min(e, extent));
+}
+
+/**
+ * Largest square C block that fits the budget with its panels, then each side
+ * grown again if the other was clipped by the matrix. Re-reads of A and B
+ * shrink with the block edge, so the panels get at most half the budget even
+ * if that makes them shallower; the depth is halved further while not even a
+ * single row fits.
+ */
+bool choose_blocking(std::int64_t M, std::int64_t N, std::int64_t K, double sizeT, double sizeAcc,
+                     double budget, OutOfCoreBlocking& out)
+{
+    const double squareEdge = std::sqrt(budget / (4 * sizeAcc));   // C blocks alone in half the budget
+    const double depth = std::min({ double(PANEL_KC * packed_blocking_from_caches(std::size_t(sizeT)).kc),
+                                    double(K), std::floor(budget / (8 * squareEdge * sizeT)) });
+    for (double kb = std::max(1.0, depth); kb >= 1; kb = std::floor(kb / 2)) {
+        // 2 sAcc b^2 + 4 kb sT b = budget
+        double b = (-4 * kb * sizeT + std::sqrt(16 * kb * kb * sizeT * sizeT + 8 * sizeAcc * budget)) / (4 * sizeAcc);
+        int mb = round_edge(b, M);
+        if (mb < 1)
+            continue;
+        int nb = round_edge((budget - 2 * mb * kb * sizeT) / (2 * mb * sizeAcc + 2 * kb * sizeT), N);
+        if (nb < 1)
+            continue;
+        mb = std::max(mb, round_edge((budget - 2 * kb * nb * sizeT) / (2 * nb * sizeAcc + 2 * kb * sizeT), M));
+        out = OutOfCoreBlocking{ mb, nb, static_cast<int>(kb) };
+        return buffer_bytes(mb, nb, kb, sizeT, sizeAcc) <= budget;
+    }
+    return false;
+}
+
+// Hand-over between the compute thread and the I/O thread.
+struct Pipeline {
+    std::mutex mutex;
+    std::condition_variable changed;
+    long long loaded = 0;            // steps whose panels are in their slot
+    long long consumed = 0;          // steps the compute thread is done with
+    std::deque<long long> writes;    // finished C blocks not written yet
+    long long written = 0;
+    bool abort = false;
+};
+
+} // namespace
+
+bool create_matrix_file(const std::string& path, const MatrixFileHeader& header, std::string* error)
+{
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!out) {
+            if (error)
+                *error = "cannot create " + path;
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::resize_file(path, sizeof(header) + std::uint64_t(header.rows) * header.cols * header.elem_size, ec);
+    if (ec && error)
+        *error = "cannot size " + path + ": " + ec.message();
+    return !ec;
+}
+
+bool MappedMatrixFile::open(const std::string& path, bool writable, std::string* error)
+{
+    close();
+    auto fail = [&](const std::string& what) {
+        if (error)
+            *error = what + " " + path;
+        close();
+        return false;
+    };
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return fail("cannot open");
+    file_ = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+        return fail("cannot stat");
+    size_ = static_cast<std::uint64_t>(size.QuadPart);
+    if (size_ < sizeof(MatrixFileHeader))
+        return fail("not a matrix file:");
+    mapping_ = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_)
+        return fail("cannot map");
+    base_ = static_cast<unsigned char*>(
+        MapViewOfFile(mapping_, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    if (!base_)
+        return fail("cannot map");
+#else
+    fd_ = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd_ < 0)
+        return fail("cannot open");
+    struct stat st;
+    if (fstat(fd_, &st) != 0)
+        return fail("cannot stat");
+    size_ = static_cast<std::uint64_t>(st.st_size);
+    if (size_ < sizeof(MatrixFileHeader))
+        return fail("not a matrix file:");
+    void* base = mmap(nullptr, size_, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, fd_, 0);
+    if (base == MAP_FAILED)
+        return fail("cannot map");
+    base_ = static_cast<unsigned char*>(base);
+#endif
+
+    std::memcpy(&header_, base_, sizeof(header_));
+    std::uint64_t dataBytes = std::uint64_t(header_.rows) * std::uint64_t(header_.cols) * header_.elem_size;
+    if (std::memcmp(header_.magic, "CAMMMAT1", sizeof(header_.magic)) != 0 || header_.rows < 0
+        || header_.cols < 0 || size_ < sizeof(MatrixFileHeader) + dataBytes)
+        return fail("not a matrix file (or truncated):");
+    return true;
+}
+
+void MappedMatrixFile::close()
+{
+#ifdef _WIN32
+    if (base_)
+        UnmapViewOfFile(base_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    if (file_)
+        CloseHandle(file_);
+#else
+    if (base_)
+        munmap(base_, size_);
+    if (fd_ >= 0)
+        ::close(fd_);
+#endif
+    base_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+    file_ = mapping_ = nullptr;
+}
+
+void MappedMatrixFile::release(std::uint64_t offset, std::uint64_t bytes)
+{
+#ifdef _WIN32
+    // Mapped views cannot drop pages selectively; Windows trims the working
+    // set under memory pressure instead.
+    (void)offset;
+    (void)bytes;
+#else
+    const std::uint64_t page = page_size();
+    std::uint64_t begin = (sizeof(MatrixFileHeader) + offset) / page * page;
+    std::uint64_t end = std::min(size_, (sizeof(MatrixFileHeader) + offset + bytes + page - 1) / page * page);
+    if (base_ && end > begin)
+        madvise(base_ + begin, end - begin, MADV_DONTNEED);
+#endif
+}
+
+void MappedMatrixFile::flush(std::uint64_t offset, std::uint64_t bytes, bool wait)
+{
+    const std::uint64_t page = page_size();
+    std::uint64_t begin = (sizeof(MatrixFileHeader) + offset) / page * page;
+    std::uint64_t end = std::min(size_, sizeof(MatrixFileHeader) + offset + bytes);
+    if (!base_ || end <= begin)
+        return;
+#ifdef _WIN32
+    FlushViewOfFile(base_ + begin, end - begin);
+    if (wait)
+        FlushFileBuffers(file_);
+#else
+    msync(base_ + begin, end - begin, wait ? MS_SYNC : MS_ASYNC);
+#endif
+}
+
+template <typename T, typename Acc>
+bool out_of_core_matmul(const std::string& pathA, const std::string& pathB, const std::string& pathC,
+                        const OutOfCoreOptions& options, OutOfCoreStats* stats, std::string* error)
+{
+    auto fail = [&](const std::string& message) {
+        if (error)
+            *error = message;
+        return false;
+    };
+    const auto start = Clock::now();
+
+    MappedMatrixFile a, b, c;
+    if (!a.open(pathA, false, error) || !b.open(pathB, false, error))
+        return false;
+    if (!a.holds<T>() || !b.holds<T>())
+        return fail("element type of " + pathA + " or " + pathB + " does not match the requested one");
+    const std::int64_t M = a.rows(), K = a.cols(), N = b.cols();
+    if (b.rows() != K)
+        return fail("inner dimensions differ: A has " + std::to_string(K) + " columns, B has "
+                    + std::to_string(b.rows()) + " rows");
+    if (std::max({ M, N, K }) > INT_MAX)
+        return fail("matrix dimensions beyond 2^31 - 1 are not supported");
+    if (!create_matrix_file(pathC, matrix_file_header<Acc>(M, N), error) || !c.open(pathC, true, error))
+        return false;
+    if (M == 0 || N == 0 || K == 0) {
+        c.flush(0, std::uint64_t(M) * N * sizeof(Acc), true);
+        return true;   // C is all zeros
+    }
+
+    OutOfCoreBlocking blk;
+    if (!choose_blocking(M, N, K, sizeof(T), sizeof(Acc), double(options.memory_budget), blk))
+        return fail("memory budget of " + std::to_string(options.memory_budget) + " bytes is too small");
+
+    const int rowBlocks = static_cast<int>((M + blk.mb - 1) / blk.mb);
+    const int colBlocks = static_cast<int>((N + blk.nb - 1) / blk.nb);
+    const int panels = static_cast<int>((K + blk.kb - 1) / blk.kb);
+    const long long blocks = static_cast<long long>(rowBlocks) * colBlocks;
+    const long long steps = blocks * panels;
+
+    Matrix<T> panelA[2] = { Matrix<T>(blk.mb, blk.kb), Matrix<T>(blk.mb, blk.kb) };
+    Matrix<T> panelB[2] = { Matrix<T>(blk.kb, blk.nb), Matrix<T>(blk.kb, blk.nb) };
+    Matrix<Acc> blockC[2] = { Matrix<Acc>(blk.mb, blk.nb), Matrix<Acc>(blk.mb, blk.nb) };
+
+    // Origin and extent of block / step s.
+    struct Step {
+        std::int64_t i0, j0, k0;
+        int rows, cols, depth;
+    };
+    auto step_at = [&](long long s) {
+        long long block = s / panels;
+        Step st;
+        st.i0 = block / colBlocks * std::int64_t(blk.mb);
+        st.j0 = block % colBlocks * std::int64_t(blk.nb);
+        st.k0 = s % panels * std::int64_t(blk.kb);
+        st.rows = static_cast<int>(std::min<std::int64_t>(blk.mb, M - st.i0));
+        st.cols = static_cast<int>(std::min<std::int64_t>(blk.nb, N - st.j0));
+        st.depth = static_cast<int>(std::min<std::int64_t>(blk.kb, K - st.k0));
+        return st;
+    };
+
+    OutOfCoreStats local;
+    local.block_rows = blk.mb;
+    local.block_cols = blk.nb;
+    local.panel_depth = blk.kb;
+    for (int i = 0; i < 2; ++i)
+        local.buffer_bytes += (panelA[i].storage_size() + panelB[i].storage_size()) * sizeof(T)
+                              + blockC[i].storage_size() * sizeof(Acc);
+
+    // Copies the A and B panels of step s out of the mappings, then unmaps them.
+    auto load = [&](long long s) {
+        const Step st = step_at(s);
+        Matrix<T>& pa = panelA[s % 2];
+        Matrix<T>& pb = panelB[s % 2];
+        const T* srcA = a.data<T>();
+        const T* srcB = b.data<T>();
+        for (int r = 0; r < st.rows; ++r)
+            std::memcpy(&pa(r, 0), srcA + (st.i0 + r) * K + st.k0, st.depth * sizeof(T));
+        for (int r = 0; r < st.depth; ++r)
+            std::memcpy(&pb(r, 0), srcB + (st.k0 + r) * N + st.j0, st.cols * sizeof(T));
+        a.release((st.i0 * K + st.k0) * sizeof(T), ((st.rows - 1) * K + st.depth) * sizeof(T));
+        b.release((st.k0 * N + st.j0) * sizeof(T), ((st.depth - 1) * N + st.cols) * sizeof(T));
+        local.bytes_read += std::int64_t(st.rows + st.cols) * st.depth * sizeof(T);
+    };
+
+    // Copies C block `block` into the mapping and starts its write-back.
+    auto store = [&](long long block) {
+        const Step st = step_at(block * panels);
+        const Matrix<Acc>& cb = blockC[block % 2];
+        Acc* dst = c.data<Acc>();
+        for (int r = 0; r < st.rows; ++r)
+            std::memcpy(dst + (st.i0 + r) * N + st.j0, &cb(r, 0), st.cols * sizeof(Acc));
+        std::uint64_t offset = (st.i0 * N + st.j0) * sizeof(Acc);
+        std::uint64_t bytes = ((st.rows - 1) * N + st.cols) * sizeof(Acc);
+        c.flush(offset, bytes, false);
+        c.release(offset, bytes);
+        local.bytes_written += std::int64_t(st.rows) * st.cols * sizeof(Acc);
+    };
+
+    Pipeline p;
+    std::thread io([&] {
+        double busy = 0;
+        std::unique_lock<std::mutex> lock(p.mutex);
+        for (;;) {
+            p.changed.wait(lock, [&] {
+                return p.abort || !p.writes.empty() || (p.loaded < steps && p.loaded < p.consumed + 2)
+                       || p.written == blocks;
+            });
+            if (p.abort)
+                break;
+            auto t0 = Clock::now();
+            if (!p.writes.empty()) {
+                // Writes first: the compute thread may be waiting for the C block.
+                long long block = p.writes.front();
+                p.writes.pop_front();
+                lock.unlock();
+                store(block);
+                busy += ms_since(t0);
+                lock.lock();
+                ++p.written;
+            } else if (p.loaded < steps && p.loaded < p.consumed + 2) {
+                long long s = p.loaded;
+                lock.unlock();
+                load(s);
+                busy += ms_since(t0);
+                lock.lock();
+                ++p.loaded;
+            } else {
+                break;   // every block written
+            }
+            p.changed.notify_all();
+        }
+        lock.unlock();
+        if (!p.abort) {
+            auto t0 = Clock::now();
+            c.flush(0, std::uint64_t(M) * N * sizeof(Acc), true);
+            busy += ms_since(t0);
+        }
+        local.io_ms = busy;
+    });
+
+    // Waits for pred under the pipeline lock, adding the time to stall_ms.
+    auto wait_for = [&](auto&& pred) {
+        std::unique_lock<std::mutex> lock(p.mutex);
+        if (pred())
+            return;
+        auto t0 = Clock::now();
+        p.changed.wait(lock, pred);
+        local.stall_ms += ms_since(t0);
+    };
+
+    try {
+        for (long long s = 0; s < steps; ++s) {
+            const long long block = s / panels;
+            const bool first = s % panels == 0;
+            if (first && block >= 2)
+                wait_for([&] { return p.written >= block - 1; });   // its buffer's previous block is out
+            wait_for([&] { return p.loaded > s; });
+
+            const Step st = step_at(s);
+            Matrix<Acc>& cb = blockC[block % 2];
+            auto t0 = Clock::now();
+            packed_gemm<T, Acc>(false, false, st.rows, st.cols, st.depth, Acc(1),
+                                panelA[s % 2].data(), panelA[s % 2].ld(), panelB[s % 2].data(), panelB[s % 2].ld(),
+                                first ? Acc(0) : Acc(1), cb.data(), cb.ld(), options.threadCount);
+            local.compute_ms += ms_since(t0);
+
+            std::lock_guard<std::mutex> lock(p.mutex);
+            p.consumed = s + 1;
+            if (s % panels == panels - 1)
+                p.writes.push_back(block);
+            p.changed.notify_all();
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(p.mutex);
+            p.abort = true;
+        }
+        p.changed.notify_all();
+        io.join();
+        throw;
+    }
+
+    // The last blocks and the final flush are I/O nothing overlaps.
+    auto t0 = Clock::now();
+    io.join();
+    local.stall_ms += ms_since(t0);
+    local.wall_ms = ms_since(start);
+    if (stats)
+        *stats = local;
+    return true;
+}
+
+#define CAMM_INSTANTIATE_OUT_OF_CORE(T, Acc)                                                  \
+    template bool out_of_core_matmul<T, Acc>(const std::string&, const std::string&,         \
+                                             const std::string&, const OutOfCoreOptions&,    \
+                                             OutOfCoreStats*, std::string*);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_OUT_OF_CORE)
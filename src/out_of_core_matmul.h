@@ -0,0 +1,159 @@
+#ifndef OUT_OF_CORE_MATMUL_H
+#define OUT_OF_CORE_MATMUL_H
+
+#include "matrix.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Matrix file: this 64-byte header, then rows x cols elements row-major with
+// no padding, in the byte order of the machine that wrote it.
+struct MatrixFileHeader {
+    char magic[8];            // "CAMMMAT1"
+    std::uint32_t elem_size;  // bytes per element
+    std::uint32_t kind;       // 'f' floating point, 'i' integer
+    std::int64_t rows;
+    std::int64_t cols;
+    unsigned char reserved[32];
+};
+static_assert(sizeof(MatrixFileHeader) == 64, "matrix file data starts at byte 64");
+
+template <typename T>
+MatrixFileHeader matrix_file_header(std::int64_t rows, std::int64_t cols)
+{
+    MatrixFileHeader header{};
+    std::memcpy(header.magic, "CAMMMAT1", sizeof(header.magic));
+    header.elem_size = sizeof(T);
+    header.kind = std::is_floating_point<T>::value ? 'f' : 'i';
+    header.rows = rows;
+    header.cols = cols;
+    return header;
+}
+
+// Creates (or truncates) a matrix file of the header's shape. The data is
+// zero and, where the file system allows, not allocated until written.
+bool create_matrix_file(const std::string& path, const MatrixFileHeader& header,
+                        std::string* error = nullptr);
+
+// Writes a rows x cols matrix file one row at a time: row(i, out) fills out[0..cols).
+template <typename T, typename RowFn>
+bool write_matrix_file(const std::string& path, std::int64_t rows, std::int64_t cols, RowFn&& row,
+                       std::string* error = nullptr)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    MatrixFileHeader header = matrix_file_header<T>(rows, cols);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::vector<T> buffer(static_cast<std::size_t>(cols));
+    for (std::int64_t i = 0; i < rows && out; ++i) {
+        row(i, buffer.data());
+        out.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(cols * sizeof(T)));
+    }
+    if (!out && error)
+        *error = "cannot write " + path;
+    return static_cast<bool>(out);
+}
+
+/**
+ * A matrix file mapped into the address space (mmap, or MapViewOfFile on
+ * Windows); pages are read from the file on first touch. Move-only.
+ */
+class MappedMatrixFile {
+public:
+    MappedMatrixFile() = default;
+    ~MappedMatrixFile() { close(); }
+
+    MappedMatrixFile(const MappedMatrixFile&) = delete;
+    MappedMatrixFile& operator=(const MappedMatrixFile&) = delete;
+
+    bool open(const std::string& path, bool writable, std::string* error = nullptr);
+    void close();
+
+    const MatrixFileHeader& header() const { return header_; }
+    std::int64_t rows() const { return header_.rows; }
+    std::int64_t cols() const { return header_.cols; }
+
+    // Whether the file's elements are of type T.
+    template <typename T>
+    bool holds() const
+    {
+        return header_.elem_size == sizeof(T) && header_.kind == (std::is_floating_point<T>::value ? 'f' : 'i');
+    }
+
+    template <typename T>
+    T* data() const { return reinterpret_cast<T*>(base_ + sizeof(MatrixFileHeader)); }
+
+    // The whole matrix; check holds<T>() first.
+    template <typename T>
+    MatrixView<T> view() const
+    {
+        return MatrixView<T>(data<T>(), static_cast<int>(rows()), static_cast<int>(cols()),
+                             static_cast<int>(cols()));
+    }
+
+    // Byte range [offset, offset + bytes) of the element data, widened to whole pages.
+    // release: unmaps its pages from this process; they stay in the page cache
+    //          (dirty ones are still written back), so memory use stays bounded.
+    // flush:   starts writing it back, and with wait = true waits for it.
+    void release(std::uint64_t offset, std::uint64_t bytes);
+    void flush(std::uint64_t offset, std::uint64_t bytes, bool wait);
+
+private:
+    unsigned char* base_ = nullptr;
+    std::uint64_t size_ = 0;
+    MatrixFileHeader header_{};
+    int fd_ = -1;               // POSIX
+    void* file_ = nullptr;      // Windows file and mapping handles
+    void* mapping_ = nullptr;
+};
+
+struct OutOfCoreOptions {
+    std::size_t memory_budget = std::size_t(256) << 20;   // bytes of panels and C blocks
+    int threadCount = 0;                                  // packed_gemm tasks, 0 = tuned
+};
+
+// What an out-of-core run did. The I/O thread's busy time is io_ms; the part
+// of it the compute thread had to wait for is stall_ms, the rest was hidden.
+struct OutOfCoreStats {
+    std::int64_t bytes_read = 0;
+    std::int64_t bytes_written = 0;
+    double wall_ms = 0;
+    double io_ms = 0;        // reading panels, writing C blocks, the final flush
+    double compute_ms = 0;
+    double stall_ms = 0;     // compute waiting for a panel or a free C block, and for the flush
+    int block_rows = 0;      // C block computed in memory
+    int block_cols = 0;
+    int panel_depth = 0;     // K extent of one A / B panel
+    std::size_t buffer_bytes = 0;
+
+    double io_gbs() const { return io_ms > 0 ? (bytes_read + bytes_written) / (io_ms * 1e6) : 0; }
+    double hidden_fraction() const
+    {
+        if (io_ms <= 0)
+            return 1;
+        double hidden = 1 - stall_ms / io_ms;
+        return hidden < 0 ? 0 : hidden;
+    }
+};
+
+/**
+ * C = A * B for matrix files too large for memory. C is created at pathC.
+ * C is computed one mb x nb block at a time in memory, accumulating over K in
+ * panels of depth kb: an A panel (mb x kb) and a B panel (kb x nb) per step,
+ * with packed_gemm on the pool. A dedicated I/O thread reads the next step's
+ * panels while the current one computes (two panel slots), and writes each
+ * finished C block back while the next block computes (two C blocks). The
+ * blocks are the largest squares whose six buffers fit the memory budget;
+ * mapped pages are released after each copy so the budget bounds memory use.
+ * Returns false with a message in `error` if a file cannot be used.
+ */
+template <typename T, typename Acc>
+bool out_of_core_matmul(const std::string& pathA, const std::string& pathB, const std::string& pathC,
+                        const OutOfCoreOptions& options, OutOfCoreStats* stats = nullptr,
+                        std::string* error = nullptr);
+
+#endif // OUT_OF_CORE_MATMUL_H
@@ -0,0 +1,339 @@
+#include "packed_matmul.h"
+#include "cache_utils.h"
+#include "simd_kernels.h"
+#include "matmul_types.h"
+#include "buffer_pool.h"
+#include "task_scheduler.h"
+#include "tuning.h"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * Packs an mc x kc block of op(A) into MR-row micro-panels.
+ * Each micro-panel stores, for every k, the MR values of column k contiguously,
+ * so the microkernel streams A with unit stride. Rows past mc are zero-padded.
+ * With transA, A points at the kc x mc block of the stored matrix and each
+ * column k of op(A) is read as a contiguous row of A.
+ */
+template <typename T>
+void pack_a(int mc, int kc, const T* A, int lda, bool transA, T* Ap)
+{
+    for (int i = 0; i < mc; i += PACK_MR) {
+        int rows = std::min(PACK_MR, mc - i);
+        for (int k = 0; k < kc; ++k) {
+            if (transA) {
+                const T* src = A + static_cast<std::ptrdiff_t>(k) * lda + i;
+                for (int r = 0; r < rows; ++r)
+                    Ap[r] = src[r];
+            } else {
+                for (int r = 0; r < rows; ++r)
+                    Ap[r] = A[static_cast<std::ptrdiff_t>(i + r) * lda + k];
+            }
+            for (int r = rows; r < PACK_MR; ++r)
+                Ap[r] = T(0);
+            Ap += PACK_MR;
+        }
+    }
+}
+
+/**
+ * Packs a kc x nc panel of op(B) into NR-column micro-panels (row k of a
+ * micro-panel holds NR consecutive values of op(B)). Columns past nc are
+ * zero-padded. With transB, B points at the nc x kc block of the stored matrix.
+ */
+template <typename T>
+void pack_b(int kc, int nc, const T* B, int ldb, bool transB, T* Bp)
+{
+    for (int j = 0; j < nc; j += PACK_NR) {
+        int cols = std::min(PACK_NR, nc - j);
+        for (int k = 0; k < kc; ++k) {
+            if (transB) {
+                for (int c = 0; c < cols; ++c)
+                    Bp[c] = B[static_cast<std::ptrdiff_t>(j + c) * ldb + k];
+            } else {
+                const T* src = B + static_cast<std::ptrdiff_t>(k) * ldb + j;
+                for (int c = 0; c < cols; ++c)
+                    Bp[c] = src[c];
+            }
+            for (int c = cols; c < PACK_NR; ++c)
+                Bp[c] = T(0);
+            Bp += PACK_NR;
+        }
+    }
+}
+
+// How a macrokernel call combines its product P with C. The first KC panel
+// applies beta (beta == 0 stores without reading C); later panels add.
+template <typename Acc>
+struct CUpdate {
+    Acc alpha;
+    Acc beta;
+
+    // C += P: the microkernel can accumulate straight into C.
+    bool accumulates() const { return alpha == Acc(1) && beta == Acc(1); }
+
+    // c[0..n) = alpha * p[0..n) + beta * c[0..n), one branch per row.
+    void store(Acc* c, const Acc* p, int n) const {
+        if (beta == Acc(0)) {
+            if (alpha == Acc(1))
+                std::copy(p, p + n, c);
+            else
+                for (int s = 0; s < n; ++s)
+                    c[s] = alpha * p[s];
+        } else if (beta == Acc(1)) {
+            for (int s = 0; s < n; ++s)
+                c[s] += alpha * p[s];
+        } else {
+            for (int s = 0; s < n; ++s)
+                c[s] = alpha * p[s] + beta * c[s];
+        }
+    }
+};
+
+/**
+ * Runs the ISA-dispatched microkernel over every MR x NR tile of an mc x nc block of C.
+ * Partial tiles, and tiles that need scaling or are overwritten, go through a
+ * scratch tile.
+ */
+template <typename T, typename Acc>
+void macrokernel(int mc, int nc, int kc, const T* Ap, const T* Bp, Acc* C, int ldc,
+                 const CUpdate<Acc>& update)
+{
+    const auto microkernel = simd_kernels<T, Acc>().microkernel;
+    const bool direct = update.accumulates();
+    Acc edge[PACK_MR * PACK_NR];
+
+    for (int j = 0; j < nc; j += PACK_NR) {
+        int cols = std::min(PACK_NR, nc - j);
+        for (int i = 0; i < mc; i += PACK_MR) {
+            int rows = std::min(PACK_MR, mc - i);
+            const T* a = Ap + i * kc;
+            const T* b = Bp + j * kc;
+            Acc* c = C + static_cast<std::ptrdiff_t>(i) * ldc + j;
+
+            if (direct && rows == PACK_MR && cols == PACK_NR) {
+                microkernel(kc, a, b, c, ldc);
+                continue;
+            }
+
+            std::fill(edge, edge + PACK_MR * PACK_NR, Acc(0));
+            microkernel(kc, a, b, edge, PACK_NR);
+            for (int r = 0; r < rows; ++r)
+                update.store(c + static_cast<std::ptrdiff_t>(r) * ldc, edge + r * PACK_NR, cols);
+        }
+    }
+}
+
+int round_down(int value, int multiple)
+{
+    return std::max(multiple, value / multiple * multiple);
+}
+
+// Pack buffer recycled through the buffer pool. pack_a / pack_b write every
+// element the microkernel reads, so it is not zeroed.
+template <typename T>
+class PackBuffer {
+public:
+    explicit PackBuffer(std::size_t elems)
+        : data_(static_cast<T*>(acquire_buffer(elems * sizeof(T), false))) {}
+    ~PackBuffer() { release_buffer(data_); }
+
+    PackBuffer(const PackBuffer&) = delete;
+    PackBuffer& operator=(const PackBuffer&) = delete;
+
+    T* data() { return data_; }
+
+private:
+    T* data_;
+};
+
+/**
+ * Goto loop nest for rows [m0, m1) of C: jc (NC) -> pc (KC) -> ic (MC).
+ */
+template <typename T, typename Acc>
+void packed_gemm_rows(int m0, int m1, int N, int K,
+                      const T* A, int lda, bool transA,
+                      const T* B, int ldb, bool transB,
+                      Acc* C, int ldc,
+                      Acc alpha, Acc beta,
+                      const PackedBlocking& blk)
+{
+    // Pack buffers only as large as this problem needs (padded to whole micro-panels).
+    int mcMax = std::min(blk.mc, (m1 - m0 + PACK_MR - 1) / PACK_MR * PACK_MR);
+    int kcMax = std::min(blk.kc, K);
+    int ncMax = std::min(blk.nc, (N + PACK_NR - 1) / PACK_NR * PACK_NR);
+    PackBuffer<T> Ap(static_cast<std::size_t>(mcMax) * kcMax);
+    PackBuffer<T> Bp(static_cast<std::size_t>(kcMax) * ncMax);
+
+    // Start of the block of op(X) at (row, col) in the stored matrix.
+    auto at = [](const T* X, int ld, bool trans, int row, int col) {
+        return trans ? X + static_cast<std::ptrdiff_t>(col) * ld + row
+                     : X + static_cast<std::ptrdiff_t>(row) * ld + col;
+    };
+
+    for (int jc = 0; jc < N; jc += blk.nc) {
+        int nc = std::min(blk.nc, N - jc);
+        for (int pc = 0; pc < K; pc += blk.kc) {
+            int kc = std::min(blk.kc, K - pc);
+            pack_b(kc, nc, at(B, ldb, transB, pc, jc), ldb, transB, Bp.data());
+            const CUpdate<Acc> update{ alpha, pc == 0 ? beta : Acc(1) };
+
+            for (int ic = m0; ic < m1; ic += blk.mc) {
+                int mc = std::min(blk.mc, m1 - ic);
+                pack_a(mc, kc, at(A, lda, transA, ic, pc), lda, transA, Ap.data());
+                macrokernel(mc, nc, kc, Ap.data(), Bp.data(), C + static_cast<std::ptrdiff_t>(ic) * ldc + jc, ldc,
+                            update);
+            }
+        }
+    }
+}
+
+} // namespace
+
+// Bytes of `cache` one worker can count on when `users` workers of the pool
+// may run on the CPUs that share it.
+static int cache_share(const CacheInfo* cache, size_t fallback, int users, size_t cap)
+{
+    size_t size = cache ? cache->size : fallback;
+    if (cache && !cache->shared_cpus.empty())
+        size /= static_cast<size_t>(std::clamp(users, 1, static_cast<int>(cache->shared_cpus.size())));
+    return static_cast<int>(std::min(size, cap));
+}
+
+/**
+ * Half of each cache level is given to the operand that should live there;
+ * the other half is left for C and the streaming operand. Every pool worker
+ * packs its own A block (L2) and B panel (L3), so a shared L2 (SMT siblings)
+ * or L3 is divided by the workers that can run under it.
+ */
+PackedBlocking packed_blocking_from_caches(std::size_t elemSize)
+{
+    const SystemTopology& topo = system_topology();
+    const int workers = TaskScheduler::instance().worker_count();
+    const int cores = std::max(1, topo.physical_cores());
+
+    const int elem = static_cast<int>(elemSize);
+    int l1 = static_cast<int>(get_l1_cache_size());
+    int l2 = cache_share(topo.data_cache(2), get_l2_cache_size(), (workers + cores - 1) / cores, 64u << 20);
+    int l3 = cache_share(topo.data_cache(3), get_l3_cache_size(), workers, 256u << 20);
+
+    PackedBlocking blk;
+    blk.kc = std::clamp(l1 / 2 / (PACK_NR * elem), 64, 1024);
+    blk.mc = std::clamp(round_down(l2 / 2 / (blk.kc * elem), PACK_MR), PACK_MR, 1020);
+    blk.nc = std::clamp(round_down(l3 / 2 / (blk.kc * elem), PACK_NR), PACK_NR, 8192);
+    return blk;
+}
+
+/**
+ * packed_blocking_from_caches for the pool as it is now: the cache sizes are
+ * fixed, but the shares depend on the worker count, which configure() (or
+ * --workers) can change. Cached per thread and recomputed when it does.
+ */
+static PackedBlocking current_blocking(std::size_t elemSize)
+{
+    struct Cached {
+        int workers = 0;
+        PackedBlocking blk;
+    };
+    thread_local Cached cached[sizeof(std::int64_t) + 1];   // by element size
+
+    const int workers = TaskScheduler::instance().worker_count();
+    Cached& slot = cached[std::min(elemSize, sizeof(std::int64_t))];
+    if (slot.workers != workers) {
+        slot.blk = packed_blocking_from_caches(elemSize);
+        slot.workers = workers;
+    }
+    return slot.blk;
+}
+
+/**
+ * Packed-panel GEMM. Tasks on the persistent pool own disjoint row ranges of C
+ * (multiples of MR), so no synchronisation is needed; each packs its own B panels.
+ * threadCount <= 0 takes the tuned task count, or one per pool worker.
+ */
+template <typename T, typename Acc>
+void packed_gemm(bool transA, bool transB, int M, int N, int K, Acc alpha,
+                 const T* A, int lda,
+                 const T* B, int ldb,
+                 Acc beta, Acc* C, int ldc,
+                 int threadCount)
+{
+    if (M <= 0 || N <= 0)
+        return;
+    if (K <= 0 || alpha == Acc(0)) {
+        scale_matrix<T, Acc>(M, N, beta, C, ldc);
+        return;
+    }
+
+    const PackedBlocking blk = current_blocking(sizeof(T));
+    if (threadCount <= 0)
+        threadCount = tuned_threads(TuneKey::PackedThreads, dtype_of<T, Acc>(), M, N, K);
+
+    int rowsPerThread = (M + std::max(1, threadCount) - 1) / std::max(1, threadCount);
+    rowsPerThread = (rowsPerThread + PACK_MR - 1) / PACK_MR * PACK_MR;
+
+    int ranges = (M + rowsPerThread - 1) / rowsPerThread;
+
+    // The calling thread takes the first row range itself.
+    parallel_for(ranges, [&](int r) {
+        int m0 = r * rowsPerThread;
+        int m1 = std::min(M, m0 + rowsPerThread);
+        packed_gemm_rows(m0, m1, N, K, A, lda, transA, B, ldb, transB, C, ldc, alpha, beta, blk);
+    });
+}
+
+template <typename T, typename Acc>
+void packed_gemm(int M, int N, int K,
+                 const T* A, int lda,
+                 const T* B, int ldb,
+                 Acc* C, int ldc,
+                 int threadCount)
+{
+    if (M <= 0 || N <= 0 || K <= 0)
+        return;
+    if (try_fixed_matmul<T, Acc>(M, N, K, A, lda, B, ldb, C, ldc))
+        return;
+    packed_gemm<T, Acc>(false, false, M, N, K, Acc(1), A, lda, B, ldb, Acc(1), C, ldc, threadCount);
+}
+
+template <typename T, typename Acc>
+void scale_matrix(int M, int N, Acc beta, Acc* C, int ldc)
+{
+    for (int i = 0; i < M; ++i) {
+        Acc* row = C + static_cast<std::ptrdiff_t>(i) * ldc;
+        if (beta == Acc(0))
+            std::fill(row, row + N, Acc(0));
+        else if (beta != Acc(1))
+            for (int j = 0; j < N; ++j)
+                row[j] *= beta;
+    }
+}
+
+template <typename T, typename Acc>
+void packed_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                   int threadCount)
+{
+    packed_gemm(C.rows(), C.cols(), A.cols(), A.data(), A.ld(), B.data(), B.ld(),
+                C.data(), C.ld(), threadCount);
+}
+
+template <typename T, typename Acc>
+void packed_matmul(const T* A, const T* B, Acc* C, int n, int threadCount)
+{
+    packed_gemm(n, n, n, A, n, B, n, C, n, threadCount);
+}
+
+#define CAMM_INSTANTIATE_PACKED(T, Acc)                                              \
+    template void packed_gemm<T, Acc>(int, int, int, const T*, int, const T*, int,   \
+                                      Acc*, int, int);                               \
+    template void packed_gemm<T, Acc>(bool, bool, int, int, int, Acc, const T*, int, \
+                                      const T*, int, Acc, Acc*, int, int);           \
+    template void scale_matrix<T, Acc>(int, int, Acc, Acc*, int);                    \
+    template void packed_matmul<T, Acc>(MatrixView<const T>, MatrixView<const T>,    \
+                                        MatrixView<Acc>, int);                       \
+    template void packed_matmul<T, Acc>(const T*, const T*, Acc*, int, int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_PACKED)
+// Strassen runs i64 products on operands already widened to int64.
+CAMM_INSTANTIATE_PACKED(std::int64_t, std::int64_t)
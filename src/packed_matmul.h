@@ -0,0 +1,59 @@
+#ifndef PACKED_MATMUL_H
+#define PACKED_MATMUL_H
+
+#include <cstddef>
+
+#include "matrix.h"
+
+// Register block of the microkernel: every call updates an MR x NR tile of C.
+constexpr int PACK_MR = 6;
+constexpr int PACK_NR = 16;
+
+// Cache blocking of the Goto/BLIS loop nest (in elements).
+//   kc: depth of a packed panel, so that a KC x NR micro-panel of B stays in L1
+//   mc: rows of the packed A block, so that MC x KC stays in L2
+//   nc: columns of the packed B panel, so that KC x NC stays in L3
+struct PackedBlocking {
+    int mc;
+    int kc;
+    int nc;
+};
+
+// Derive MC/KC/NC from the cache hierarchy in system_topology() (per-worker
+// share of shared L2/L3), for packed operands of elemSize bytes.
+PackedBlocking packed_blocking_from_caches(std::size_t elemSize = sizeof(int));
+
+// C(MxN) += A(MxK) * B(KxN), all row-major with leading dimensions lda/ldb/ldc.
+// Instantiated for every type pair in matmul_types.h.
+template <typename T, typename Acc>
+void packed_gemm(int M, int N, int K,
+                 const T* A, int lda,
+                 const T* B, int ldb,
+                 Acc* C, int ldc,
+                 int threadCount);
+
+// C = alpha * op(A) * op(B) + beta * C, with op(X) = X^T when transX. The
+// transposes are read during packing, so nothing is copied; with beta == 0 C
+// is written without being read (its old contents may be anything).
+template <typename T, typename Acc>
+void packed_gemm(bool transA, bool transB, int M, int N, int K, Acc alpha,
+                 const T* A, int lda,
+                 const T* B, int ldb,
+                 Acc beta, Acc* C, int ldc,
+                 int threadCount);
+
+// C(MxN) = beta * C; beta == 0 clears C without reading it. T only selects
+// the instantiation.
+template <typename T, typename Acc>
+void scale_matrix(int M, int N, Acc beta, Acc* C, int ldc);
+
+// C += A * B on views, same calling convention as cache_aware_matmul_1D.
+template <typename T, typename Acc>
+void packed_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                   int threadCount);
+
+// Square n x n buffers from allocate_aligned_matrix.
+template <typename T, typename Acc>
+void packed_matmul(const T* A, const T* B, Acc* C, int n, int threadCount);
+
+#endif // PACKED_MATMUL_H
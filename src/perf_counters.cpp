@@ -0,0 +1,228 @@
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+    #include <dirent.h>
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+const char* perf_event_name(PerfEvent event)
+{
+    switch (event) {
+    case PerfEvent::Cycles:       return "Cycles";
+    case PerfEvent::Instructions: return "Instructions";
+    case PerfEvent::L1DMisses:    return "L1DMisses";
+    case PerfEvent::LLCMisses:    return "LLCMisses";
+    case PerfEvent::DTLBMisses:   return "DTLBMisses";
+    default:                      return "unknown";
+    }
+}
+
+bool PerfSample::any() const
+{
+    for (long long count : counts)
+        if (count >= 0)
+            return true;
+    return false;
+}
+
+#ifdef __linux__
+
+namespace {
+
+constexpr std::uint64_t cache_event(std::uint64_t cache, std::uint64_t op, std::uint64_t result)
+{
+    return cache | (op << 8) | (result << 16);
+}
+
+void describe(PerfEvent event, perf_event_attr& attr)
+{
+    switch (event) {
+    case PerfEvent::Cycles:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PerfEvent::Instructions:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PerfEvent::L1DMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                  PERF_COUNT_HW_CACHE_RESULT_MISS);
+        break;
+    case PerfEvent::LLCMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ,
+                                  PERF_COUNT_HW_CACHE_RESULT_MISS);
+        break;
+    case PerfEvent::DTLBMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                  PERF_COUNT_HW_CACHE_RESULT_MISS);
+        break;
+    default:
+        break;
+    }
+}
+
+int open_counter(PerfEvent event, int tid)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    describe(event, attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;   // allowed up to perf_event_paranoid = 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0));
+}
+
+std::vector<int> process_threads()
+{
+    std::vector<int> tids;
+    if (DIR* dir = opendir("/proc/self/task")) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.')
+                tids.push_back(std::atoi(entry->d_name));
+        }
+        closedir(dir);
+    }
+    if (tids.empty())
+        tids.push_back(0);   // calling thread only
+    std::sort(tids.begin(), tids.end());
+    return tids;
+}
+
+} // namespace
+
+PerfCounters::PerfCounters()
+{
+    open(process_threads());
+}
+
+PerfCounters::~PerfCounters()
+{
+    close_all();
+}
+
+void PerfCounters::open(const std::vector<int>& tids)
+{
+    tids_ = tids;
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        for (int tid : tids) {
+            int fd = open_counter(static_cast<PerfEvent>(e), tid);
+            if (fd < 0) {
+                // A count missing some threads would look valid but be too low.
+                for (int opened : fds_[e])
+                    close(opened);
+                fds_[e].clear();
+                break;
+            }
+            fds_[e].push_back(fd);
+        }
+    }
+}
+
+void PerfCounters::close_all()
+{
+    for (auto& fds : fds_) {
+        for (int fd : fds)
+            close(fd);
+        fds.clear();
+    }
+}
+
+void PerfCounters::start()
+{
+    std::vector<int> tids = process_threads();
+    if (tids != tids_) {
+        close_all();
+        open(tids);
+    }
+
+    for (auto& fds : fds_) {
+        for (int fd : fds) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+PerfSample PerfCounters::stop()
+{
+    for (auto& fds : fds_)
+        for (int fd : fds)
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+    PerfSample sample;
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        if (fds_[e].empty())
+            continue;
+        double total = 0;
+        for (int fd : fds_[e]) {
+            std::uint64_t values[3] = {};   // value, time enabled, time running
+            if (read(fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)))
+                continue;
+            if (values[2] > 0)
+                total += static_cast<double>(values[0]) * values[1] / values[2];
+        }
+        sample.counts[e] = static_cast<long long>(total);
+    }
+    return sample;
+}
+
+int PerfCounters::available_events() const
+{
+    int count = 0;
+    for (const auto& fds : fds_)
+        count += fds.empty() ? 0 : 1;
+    return count;
+}
+
+bool perf_counters_available(std::string* reason)
+{
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        int fd = open_counter(static_cast<PerfEvent>(e), 0);
+        if (fd >= 0) {
+            close(fd);
+            return true;
+        }
+    }
+    if (reason) {
+        *reason = std::strerror(errno);
+        if (errno == EACCES || errno == EPERM)
+            *reason += " (see /proc/sys/kernel/perf_event_paranoid)";
+        else if (errno == ENOENT || errno == EOPNOTSUPP)
+            *reason += " (no hardware PMU, e.g. inside a VM)";
+    }
+    return false;
+}
+
+#else // !__linux__
+
+PerfCounters::PerfCounters() {}
+PerfCounters::~PerfCounters() {}
+void PerfCounters::open(const std::vector<int>&) {}
+void PerfCounters::close_all() {}
+void PerfCounters::start() {}
+PerfSample PerfCounters::stop() { return PerfSample(); }
+int PerfCounters::available_events() const { return 0; }
+
+bool perf_counters_available(std::string* reason)
+{
+    if (reason)
+        *reason = "perf_event_open is Linux only";
+    return false;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <string>
+#include <vector>
+
+// Hardware events counted around each measured kernel run.
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    L1DMisses,      // L1 data cache read misses
+    LLCMisses,      // last-level cache read misses
+    DTLBMisses,     // data TLB read misses
+    Count
+};
+constexpr int PERF_EVENT_COUNT = static_cast<int>(PerfEvent::Count);
+
+// Short CSV-friendly name ("Cycles", "L1DMisses", ...).
+const char* perf_event_name(PerfEvent event);
+
+// Counts of one run, -1 for events that could not be counted. Counts are
+// scaled up if the kernel multiplexed the counters.
+struct PerfSample {
+    std::array<long long, PERF_EVENT_COUNT> counts;
+
+    PerfSample() { counts.fill(-1); }
+    long long operator[](PerfEvent event) const { return counts[static_cast<int>(event)]; }
+    bool any() const;
+};
+
+/**
+ * User-space counters (perf_event_open, Linux only) on every thread of the
+ * process -- the caller and the pool workers. Construction opens them
+ * disabled; start() zeroes and enables, stop() disables and reads, so one
+ * object serves every repetition of a benchmark. start() reopens the events
+ * if the set of threads changed since (e.g. the pool was restarted). An event
+ * is open on all threads or on none: one the kernel refuses for any thread
+ * (paranoid setting, containers, VMs without a virtual PMU, other OSes)
+ * reads as -1 rather than as a partial count.
+ */
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    void start();
+    PerfSample stop();
+
+    // Number of events open on every thread.
+    int available_events() const;
+
+private:
+    void open(const std::vector<int>& tids);
+    void close_all();
+
+    std::vector<int> tids_;                               // threads the fds belong to
+    std::array<std::vector<int>, PERF_EVENT_COUNT> fds_;  // per event, one fd per thread
+};
+
+// Whether any counter can be opened here; when none can, `reason` says why.
+bool perf_counters_available(std::string* reason = nullptr);
+
+#endif // PERF_COUNTERS_H
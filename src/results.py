@@ -7,6 +7,10 @@ plt.plot(df['Size'], df['Naive'], label='Naive')
 plt.plot(df['Size'], df['CacheAware'], label='Cache-Aware')
 plt.plot(df['Size'], df['CacheOblivious'], label='Cache-Oblivious')
 plt.plot(df['Size'], df['CacheAware1D'], label = 'Cache-Aware 1D')
+plt.plot(df['Size'], df['Packed'], label = 'Packed GEMM')
+plt.plot(df['Size'], df['CacheObliviousMorton'], label = 'Cache-Oblivious (Morton)')
+plt.plot(df['Size'], df['CacheObliviousParallel'], label = 'Cache-Oblivious (parallel)')
+plt.plot(df['Size'], df['Strassen'], label = 'Strassen-Winograd')
 
 plt.xlabel("Matrix Size (NxN)")
 plt.ylabel("Time (ms)")
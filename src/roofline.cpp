@@ -0,0 +1,147 @@
+#include "roofline.h"
+#include "aligned_buffer.h"
+#include "buffer_pool.h"
+#include "cache_utils.h"
+#include "matmul_types.h"
+#include "packed_matmul.h"
+#include "simd_kernels.h"
+#include "task_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Fastest of `runs` calls of fn, in seconds.
+template <typename Fn>
+double best_seconds(int runs, Fn&& fn)
+{
+    double best = 1e300;
+    for (int r = 0; r < runs; ++r) {
+        auto start = Clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+/**
+ * Every task owns one MR x kc panel of A, one kc x NR panel of B and an
+ * MR x NR tile of C (about 24 KiB for int32 at kc = 256), so the loads hit L1
+ * and the result is the throughput of the register-blocked kernel itself.
+ */
+template <typename T, typename Acc>
+double measure_peak_gops(int threadCount)
+{
+    const int kc = 256;
+    const int tasks = std::max(1, threadCount);
+    const auto microkernel = simd_kernels<T, Acc>().microkernel;
+
+    struct Panels {
+        T* a;
+        T* b;
+        Acc* c;
+    };
+    std::vector<Panels> panels(tasks);
+    for (Panels& p : panels) {
+        p.a = static_cast<T*>(acquire_buffer(sizeof(T) * PACK_MR * kc));
+        p.b = static_cast<T*>(acquire_buffer(sizeof(T) * PACK_NR * kc));
+        p.c = static_cast<Acc*>(acquire_buffer(sizeof(Acc) * PACK_MR * PACK_NR));
+        std::fill(p.a, p.a + PACK_MR * kc, T(1));
+        std::fill(p.b, p.b + PACK_NR * kc, T(0));
+    }
+
+    // Enough calls that one run takes ~20 ms on a single task.
+    double callSeconds = best_seconds(3, [&] {
+        for (int r = 0; r < 1000; ++r)
+            microkernel(kc, panels[0].a, panels[0].b, panels[0].c, PACK_NR);
+    }) / 1000;
+    long long calls = std::max(1000LL, static_cast<long long>(0.02 / std::max(callSeconds, 1e-12)));
+
+    double seconds = best_seconds(3, [&] {
+        parallel_for(tasks, [&](int t) {
+            const Panels& p = panels[t];
+            for (long long r = 0; r < calls; ++r)
+                microkernel(kc, p.a, p.b, p.c, PACK_NR);
+        });
+    });
+
+    for (Panels& p : panels) {
+        release_buffer(p.a);
+        release_buffer(p.b);
+        release_buffer(p.c);
+    }
+    double ops = 2.0 * PACK_MR * PACK_NR * kc * static_cast<double>(calls) * tasks;
+    return ops / seconds * 1e-9;
+}
+
+/**
+ * Arrays of max(32 MiB, 2 x last-level cache) each, capped at 128 MiB, split
+ * into one contiguous chunk per task. They are allocated outside the buffer
+ * pool and freed afterwards: a one-off probe must not leave up to 384 MiB
+ * cached for the rest of the process.
+ */
+double measure_stream_bandwidth(int threadCount)
+{
+    const int tasks = std::max(1, threadCount);
+    std::size_t llc = std::max(get_l3_cache_size(), get_l2_cache_size());
+    std::size_t bytes = std::clamp<std::size_t>(2 * llc, std::size_t(32) << 20, std::size_t(128) << 20);
+    std::size_t n = bytes / sizeof(double);
+
+    double* a = static_cast<double*>(allocate_aligned_bytes(n * sizeof(double)));
+    double* b = static_cast<double*>(allocate_aligned_bytes(n * sizeof(double)));
+    double* c = static_cast<double*>(allocate_aligned_bytes(n * sizeof(double)));
+
+    std::size_t chunk = (n + tasks - 1) / tasks;
+    auto for_chunks = [&](auto&& body) {
+        parallel_for(tasks, [&](int t) {
+            std::size_t begin = std::min(n, t * chunk);
+            std::size_t end = std::min(n, begin + chunk);
+            body(begin, end);
+        });
+    };
+
+    for_chunks([&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            a[i] = 0.0;
+            b[i] = 1.0;
+            c[i] = 2.0;
+        }
+    });
+
+    const double scalar = 3.0;
+    double seconds = best_seconds(5, [&] {
+        for_chunks([&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+                a[i] = b[i] + scalar * c[i];
+        });
+    });
+
+    free_aligned_bytes(a);
+    free_aligned_bytes(b);
+    free_aligned_bytes(c);
+    return 3.0 * sizeof(double) * n / seconds * 1e-9;
+}
+
+RooflinePoint place_on_roofline(double ops, double bytes, double ms, const MachineCeilings& roof)
+{
+    RooflinePoint point;
+    double seconds = ms * 1e-3;
+    point.gops = ops / seconds * 1e-9;
+    point.gbs = bytes / seconds * 1e-9;
+    point.intensity = bytes > 0 ? ops / bytes : 0;
+    double memoryRoof = point.intensity * roof.bandwidth_gbs;
+    point.memory_bound = memoryRoof < roof.peak_gops;
+    point.attainable_gops = std::min(roof.peak_gops, memoryRoof);
+    point.efficiency = point.attainable_gops > 0 ? point.gops / point.attainable_gops : 0;
+    return point;
+}
+
+#define CAMM_INSTANTIATE_ROOFLINE(T, Acc) \
+    template double measure_peak_gops<T, Acc>(int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_ROOFLINE)
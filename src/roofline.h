@@ -0,0 +1,36 @@
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include <cstddef>
+
+// Measured ceilings of this machine, for placing kernels on a roofline.
+struct MachineCeilings {
+    double peak_gops;       // compute roof: ops (2 per multiply-add) per ns
+    double bandwidth_gbs;   // memory roof: bytes per ns from DRAM
+};
+
+// Compute roof for a type pair: the packed microkernel (see simd_kernels.h)
+// run back to back on L1-resident panels by threadCount pool tasks, so
+// nothing but the multiply-add pipeline limits it. Best of a few runs.
+template <typename T, typename Acc>
+double measure_peak_gops(int threadCount);
+
+// Memory roof: STREAM triad (a[i] = b[i] + s * c[i] over doubles, 24 bytes
+// per element) on arrays several times the last-level cache, split across
+// threadCount pool tasks. Best of a few runs.
+double measure_stream_bandwidth(int threadCount);
+
+// Where one measured run sits under the roofline.
+struct RooflinePoint {
+    double gops;              // achieved
+    double gbs;               // achieved memory bandwidth for the estimated traffic
+    double intensity;         // ops per byte of memory traffic
+    double attainable_gops;   // min(peak, intensity * bandwidth)
+    double efficiency;        // gops / attainable_gops
+    bool memory_bound;        // the bandwidth roof is the lower one at this intensity
+};
+
+// ops and bytes of one run that took `ms` milliseconds.
+RooflinePoint place_on_roofline(double ops, double bytes, double ms, const MachineCeilings& roof);
+
+#endif // ROOFLINE_H
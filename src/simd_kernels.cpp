@@ -0,0 +1,650 @@
+#include "simd_kernels.h"
+#include "fixed_matmul.h"
+#include "packed_matmul.h"
+#include "matmul_types.h"
+
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define CAMM_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        // MSVC accepts any intrinsic without a per-function target.
+        #define CAMM_TARGET(isa)
+        #define CAMM_INLINE __forceinline
+    #else
+        #include <cpuid.h>
+        #define CAMM_TARGET(isa) __attribute__((target(isa)))
+        #define CAMM_INLINE inline __attribute__((always_inline))
+    #endif
+#endif
+
+#ifndef CAMM_INLINE
+    #define CAMM_INLINE inline
+#endif
+
+static_assert(PACK_MR == 6 && PACK_NR == 16,
+              "SIMD microkernels are written for a 6x16 register block");
+
+//------------------------------------------------------------------------------
+// Generic kernels. Always inlined into the per-ISA wrappers below, so each copy
+// is vectorized for that wrapper's target; the plain instantiation is the
+// scalar fallback (whatever the baseline ISA auto-vectorizes to).
+//------------------------------------------------------------------------------
+
+template <typename T, typename Acc>
+CAMM_INLINE void axpy_generic(Acc* c, const T* b, Acc a, int n)
+{
+    for (int j = 0; j < n; ++j)
+        c[j] += a * static_cast<Acc>(b[j]);
+}
+
+template <typename T, typename Acc>
+CAMM_INLINE void microkernel_generic(int kc, const T* Ap, const T* Bp, Acc* C, int ldc)
+{
+    Acc acc[PACK_MR][PACK_NR] = {};
+
+    for (int p = 0; p < kc; ++p) {
+        for (int i = 0; i < PACK_MR; ++i) {
+            Acc a = static_cast<Acc>(Ap[i]);
+            for (int j = 0; j < PACK_NR; ++j)
+                acc[i][j] += a * static_cast<Acc>(Bp[j]);
+        }
+        Ap += PACK_MR;
+        Bp += PACK_NR;
+    }
+
+    for (int i = 0; i < PACK_MR; ++i)
+        for (int j = 0; j < PACK_NR; ++j)
+            C[i * ldc + j] += acc[i][j];
+}
+
+// The fixed-size kernels are matmul<E, E, E> from fixed_matmul.h, inlined
+// into each per-ISA wrapper below.
+template <int E, int RowBytes, typename T, typename Acc>
+CAMM_INLINE void small_gemm_generic(const T* A, int lda, const T* B, int ldb, Acc* C, int ldc)
+{
+    matmul<E, E, E, T, Acc, RowBytes>(A, lda, B, ldb, C, ldc);
+}
+
+// The same template at compile time.
+constexpr std::array<int, 4> FIXED_MATMUL_CHECK =
+    matmul<2, 3, 2, int>(std::array<int, 6>{ 1, 2, 3, 4, 5, 6 },
+                         std::array<int, 6>{ 7, 8, 9, 10, 11, 12 });
+static_assert(FIXED_MATMUL_CHECK[0] == 58 && FIXED_MATMUL_CHECK[1] == 64 &&
+              FIXED_MATMUL_CHECK[2] == 139 && FIXED_MATMUL_CHECK[3] == 154,
+              "fixed-size matmul must be usable in constant expressions");
+
+template <typename T, typename Acc>
+static void axpy_scalar(Acc* c, const T* b, Acc a, int n)
+{
+    axpy_generic(c, b, a, n);
+}
+
+template <typename T, typename Acc>
+static void microkernel_scalar(int kc, const T* Ap, const T* Bp, Acc* C, int ldc)
+{
+    microkernel_generic(kc, Ap, Bp, C, ldc);
+}
+
+template <int E, typename T, typename Acc>
+static void small_gemm_scalar(const T* A, int lda, const T* B, int ldb, Acc* C, int ldc)
+{
+    small_gemm_generic<E, 32>(A, lda, B, ldb, C, ldc);
+}
+
+#ifdef CAMM_X86
+
+#define CAMM_GENERIC_KERNELS_FOR(suffix, isa, rowBytes)                                    \
+    template <typename T, typename Acc>                                                   \
+    CAMM_TARGET(isa) static void axpy_##suffix(Acc* c, const T* b, Acc a, int n)          \
+    {                                                                                     \
+        axpy_generic(c, b, a, n);                                                         \
+    }                                                                                     \
+    template <typename T, typename Acc>                                                   \
+    CAMM_TARGET(isa) static void microkernel_##suffix(int kc, const T* Ap, const T* Bp,   \
+                                                      Acc* C, int ldc)                    \
+    {                                                                                     \
+        microkernel_generic(kc, Ap, Bp, C, ldc);                                          \
+    }                                                                                     \
+    template <int E, typename T, typename Acc>                                            \
+    CAMM_TARGET(isa) static void small_gemm_##suffix(const T* A, int lda, const T* B,     \
+                                                     int ldb, Acc* C, int ldc)            \
+    {                                                                                     \
+        small_gemm_generic<E, rowBytes>(A, lda, B, ldb, C, ldc);                          \
+    }
+
+CAMM_GENERIC_KERNELS_FOR(sse41, "sse4.1", 32)
+CAMM_GENERIC_KERNELS_FOR(avx2, "avx2,fma", 64)
+CAMM_GENERIC_KERNELS_FOR(avx512, "avx512f", 64)
+
+//------------------------------------------------------------------------------
+// SSE4.1 (pmulld)
+//------------------------------------------------------------------------------
+
+CAMM_TARGET("sse4.1")
+static void axpy_i32_sse41(int* c, const int* b, int a, int n)
+{
+    __m128i va = _mm_set1_epi32(a);
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + j));
+        vc = _mm_add_epi32(vc, _mm_mullo_epi32(va, vb));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(c + j), vc);
+    }
+    for (; j < n; ++j)
+        c[j] += a * b[j];
+}
+
+/**
+ * 16 xmm registers cannot hold the 6x16 tile, so the kernel makes two passes
+ * over the packed depth, one per 8-column half (12 accumulators each).
+ */
+CAMM_TARGET("sse4.1")
+static void microkernel_i32_sse41(int kc, const int* Ap, const int* Bp, int* C, int ldc)
+{
+    for (int half = 0; half < PACK_NR; half += 8) {
+        __m128i acc[PACK_MR][2];
+        for (int i = 0; i < PACK_MR; ++i)
+            acc[i][0] = acc[i][1] = _mm_setzero_si128();
+
+        const int* a = Ap;
+        const int* b = Bp + half;
+        for (int p = 0; p < kc; ++p) {
+            __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+            __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 4));
+            for (int i = 0; i < PACK_MR; ++i) {
+                __m128i va = _mm_set1_epi32(a[i]);
+                acc[i][0] = _mm_add_epi32(acc[i][0], _mm_mullo_epi32(va, b0));
+                acc[i][1] = _mm_add_epi32(acc[i][1], _mm_mullo_epi32(va, b1));
+            }
+            a += PACK_MR;
+            b += PACK_NR;
+        }
+
+        for (int i = 0; i < PACK_MR; ++i) {
+            int* c = C + i * ldc + half;
+            for (int v = 0; v < 2; ++v) {
+                __m128i* dst = reinterpret_cast<__m128i*>(c + 4 * v);
+                _mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), acc[i][v]));
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// AVX2
+//------------------------------------------------------------------------------
+
+CAMM_TARGET("avx2")
+static void axpy_i32_avx2(int* c, const int* b, int a, int n)
+{
+    __m256i va = _mm256_set1_epi32(a);
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + j));
+        vc = _mm256_add_epi32(vc, _mm256_mullo_epi32(va, vb));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + j), vc);
+    }
+    for (; j < n; ++j)
+        c[j] += a * b[j];
+}
+
+CAMM_TARGET("avx2")
+static void microkernel_i32_avx2(int kc, const int* Ap, const int* Bp, int* C, int ldc)
+{
+    __m256i acc[PACK_MR][2];
+    for (int i = 0; i < PACK_MR; ++i)
+        acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+
+    for (int p = 0; p < kc; ++p) {
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Bp));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Bp + 8));
+        for (int i = 0; i < PACK_MR; ++i) {
+            __m256i va = _mm256_set1_epi32(Ap[i]);
+            acc[i][0] = _mm256_add_epi32(acc[i][0], _mm256_mullo_epi32(va, b0));
+            acc[i][1] = _mm256_add_epi32(acc[i][1], _mm256_mullo_epi32(va, b1));
+        }
+        Ap += PACK_MR;
+        Bp += PACK_NR;
+    }
+
+    for (int i = 0; i < PACK_MR; ++i) {
+        int* c = C + i * ldc;
+        for (int v = 0; v < 2; ++v) {
+            __m256i* dst = reinterpret_cast<__m256i*>(c + 8 * v);
+            _mm256_storeu_si256(dst, _mm256_add_epi32(_mm256_loadu_si256(dst), acc[i][v]));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// AVX-512F
+//------------------------------------------------------------------------------
+
+CAMM_TARGET("avx512f")
+static void axpy_i32_avx512(int* c, const int* b, int a, int n)
+{
+    __m512i va = _mm512_set1_epi32(a);
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m512i vb = _mm512_loadu_si512(b + j);
+        __m512i vc = _mm512_loadu_si512(c + j);
+        _mm512_storeu_si512(c + j, _mm512_add_epi32(vc, _mm512_mullo_epi32(va, vb)));
+    }
+    if (j < n) {
+        __mmask16 m = static_cast<__mmask16>((1u << (n - j)) - 1);
+        __m512i vb = _mm512_maskz_loadu_epi32(m, b + j);
+        __m512i vc = _mm512_maskz_loadu_epi32(m, c + j);
+        _mm512_mask_storeu_epi32(c + j, m, _mm512_add_epi32(vc, _mm512_mullo_epi32(va, vb)));
+    }
+}
+
+CAMM_TARGET("avx512f")
+static void microkernel_i32_avx512(int kc, const int* Ap, const int* Bp, int* C, int ldc)
+{
+    __m512i acc[PACK_MR];
+    for (int i = 0; i < PACK_MR; ++i)
+        acc[i] = _mm512_setzero_si512();
+
+    for (int p = 0; p < kc; ++p) {
+        __m512i vb = _mm512_loadu_si512(Bp);
+        for (int i = 0; i < PACK_MR; ++i)
+            acc[i] = _mm512_add_epi32(acc[i], _mm512_mullo_epi32(_mm512_set1_epi32(Ap[i]), vb));
+        Ap += PACK_MR;
+        Bp += PACK_NR;
+    }
+
+    for (int i = 0; i < PACK_MR; ++i) {
+        int* c = C + i * ldc;
+        _mm512_storeu_si512(c, _mm512_add_epi32(_mm512_loadu_si512(c), acc[i]));
+    }
+}
+
+//------------------------------------------------------------------------------
+// float / double FMA microkernels (the loops above cannot keep the 6x16 tile
+// in registers for floating point, so these are written out like the int32 ones)
+//------------------------------------------------------------------------------
+
+CAMM_TARGET("avx2,fma")
+static void microkernel_f32_avx2(int kc, const float* Ap, const float* Bp, float* C, int ldc)
+{
+    __m256 acc[PACK_MR][2];
+    for (int i = 0; i < PACK_MR; ++i)
+        acc[i][0] = acc[i][1] = _mm256_setzero_ps();
+
+    for (int p = 0; p < kc; ++p) {
+        __m256 b0 = _mm256_loadu_ps(Bp);
+        __m256 b1 = _mm256_loadu_ps(Bp + 8);
+        for (int i = 0; i < PACK_MR; ++i) {
+            __m256 va = _mm256_broadcast_ss(Ap + i);
+            acc[i][0] = _mm256_fmadd_ps(va, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(va, b1, acc[i][1]);
+        }
+        Ap += PACK_MR;
+        Bp += PACK_NR;
+    }
+
+    for (int i = 0; i < PACK_MR; ++i) {
+        float* c = C + i * ldc;
+        _mm256_storeu_ps(c,     _mm256_add_ps(_mm256_loadu_ps(c),     acc[i][0]));
+        _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), acc[i][1]));
+    }
+}
+
+CAMM_TARGET("avx512f")
+static void microkernel_f32_avx512(int kc, const float* Ap, const float* Bp, float* C, int ldc)
+{
+    __m512 acc[PACK_MR];
+    for (int i = 0; i < PACK_MR; ++i)
+        acc[i] = _mm512_setzero_ps();
+
+    for (int p = 0; p < kc; ++p) {
+        __m512 vb = _mm512_loadu_ps(Bp);
+        for (int i = 0; i < PACK_MR; ++i)
+            acc[i] = _mm512_fmadd_ps(_mm512_set1_ps(Ap[i]), vb, acc[i]);
+        Ap += PACK_MR;
+        Bp += PACK_NR;
+    }
+
+    for (int i = 0; i < PACK_MR; ++i) {
+        float* c = C + i * ldc;
+        _mm512_storeu_ps(c, _mm512_add_ps(_mm512_loadu_ps(c), acc[i]));
+    }
+}
+
+/**
+ * A 6x16 double tile needs 24 ymm registers, so like the SSE4.1 int32 kernel
+ * this one makes two passes, one per 8-column half.
+ */
+CAMM_TARGET("avx2,fma")
+static void microkernel_f64_avx2(int kc, const double* Ap, const double* Bp, double* C, int ldc)
+{
+    for (int half = 0; half < PACK_NR; half += 8) {
+        __m256d acc[PACK_MR][2];
+        for (int i = 0; i < PACK_MR; ++i)
+            acc[i][0] = acc[i][1] = _mm256_setzero_pd();
+
+        const double* a = Ap;
+        const double* b = Bp + half;
+        for (int p = 0; p < kc; ++p) {
+            __m256d b0 = _mm256_loadu_pd(b);
+            __m256d b1 = _mm256_loadu_pd(b + 4);
+            for (int i = 0; i < PACK_MR; ++i) {
+                __m256d va = _mm256_broadcast_sd(a + i);
+                acc[i][0] = _mm256_fmadd_pd(va, b0, acc[i][0]);
+                acc[i][1] = _mm256_fmadd_pd(va, b1, acc[i][1]);
+            }
+            a += PACK_MR;
+            b += PACK_NR;
+        }
+
+        for (int i = 0; i < PACK_MR; ++i) {
+            double* c = C + i * ldc + half;
+            _mm256_storeu_pd(c,     _mm256_add_pd(_mm256_loadu_pd(c),     acc[i][0]));
+            _mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), acc[i][1]));
+        }
+    }
+}
+
+CAMM_TARGET("avx512f")
+static void microkernel_f64_avx512(int kc, const double* Ap, const double* Bp, double* C, int ldc)
+{
+    __m512d acc[PACK_MR][2];
+    for (int i = 0; i < PACK_MR; ++i)
+        acc[i][0] = acc[i][1] = _mm512_setzero_pd();
+
+    for (int p = 0; p < kc; ++p) {
+        __m512d b0 = _mm512_loadu_pd(Bp);
+        __m512d b1 = _mm512_loadu_pd(Bp + 8);
+        for (int i = 0; i < PACK_MR; ++i) {
+            __m512d va = _mm512_set1_pd(Ap[i]);
+            acc[i][0] = _mm512_fmadd_pd(va, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_pd(va, b1, acc[i][1]);
+        }
+        Ap += PACK_MR;
+        Bp += PACK_NR;
+    }
+
+    for (int i = 0; i < PACK_MR; ++i) {
+        double* c = C + i * ldc;
+        _mm512_storeu_pd(c,     _mm512_add_pd(_mm512_loadu_pd(c),     acc[i][0]));
+        _mm512_storeu_pd(c + 8, _mm512_add_pd(_mm512_loadu_pd(c + 8), acc[i][1]));
+    }
+}
+
+//------------------------------------------------------------------------------
+// CPUID / XGETBV
+//------------------------------------------------------------------------------
+
+static void cpuid(int leaf, int subleaf, unsigned regs[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuidex(r, leaf, subleaf);
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned>(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// XCR0: which register states the OS saves on context switch.
+static unsigned long long read_xcr0()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+}
+
+#endif // CAMM_X86
+
+Isa detect_isa()
+{
+#ifdef CAMM_X86
+    unsigned r[4];
+    cpuid(0, 0, r);
+    unsigned maxLeaf = r[0];
+
+    cpuid(1, 0, r);
+    bool sse41   = (r[2] >> 19) & 1;
+    bool fma     = (r[2] >> 12) & 1;
+    bool osxsave = (r[2] >> 27) & 1;
+    if (!sse41)
+        return Isa::Scalar;
+    if (!osxsave || maxLeaf < 7)
+        return Isa::SSE41;
+
+    unsigned long long xcr0 = read_xcr0();
+    bool ymmState = (xcr0 & 0x6) == 0x6;     // XMM + YMM
+    bool zmmState = (xcr0 & 0xE6) == 0xE6;   // + opmask, ZMM_Hi256, Hi16_ZMM
+
+    cpuid(7, 0, r);
+    bool avx2    = (r[1] >> 5) & 1;
+    bool avx512f = (r[1] >> 16) & 1;
+
+    if (avx512f && zmmState)
+        return Isa::AVX512;
+    if (avx2 && fma && ymmState)
+        return Isa::AVX2;
+    return Isa::SSE41;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+bool isa_supported(Isa isa)
+{
+    return static_cast<int>(isa) <= static_cast<int>(detect_isa());
+}
+
+const char* isa_name(Isa isa)
+{
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE41:  return "sse4.1";
+        case Isa::AVX2:   return "avx2";
+        case Isa::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+bool parse_isa(const std::string& name, Isa& out)
+{
+    if (name == "scalar")                     { out = Isa::Scalar; return true; }
+    if (name == "sse4.1" || name == "sse41")  { out = Isa::SSE41;  return true; }
+    if (name == "avx2")                       { out = Isa::AVX2;   return true; }
+    if (name == "avx512" || name == "avx512f"){ out = Isa::AVX512; return true; }
+    return false;
+}
+
+template <typename T, typename Acc>
+static const SimdKernels<T, Acc>& kernels_for(Isa isa)
+{
+    static const SimdKernels<T, Acc> scalar = { axpy_scalar<T, Acc>, microkernel_scalar<T, Acc> };
+#ifdef CAMM_X86
+    static const SimdKernels<T, Acc> sse41  = { axpy_sse41<T, Acc>,  microkernel_sse41<T, Acc> };
+    static const SimdKernels<T, Acc> avx2   = { axpy_avx2<T, Acc>,   microkernel_avx2<T, Acc> };
+    static const SimdKernels<T, Acc> avx512 = { axpy_avx512<T, Acc>, microkernel_avx512<T, Acc> };
+
+    switch (isa) {
+        case Isa::AVX512: return avx512;
+        case Isa::AVX2:   return avx2;
+        case Isa::SSE41:  return sse41;
+        default:          break;
+    }
+#else
+    (void)isa;
+#endif
+    return scalar;
+}
+
+// int32 -> int32 uses the hand-written intrinsics instead of the generic loops.
+template <>
+const SimdKernels<std::int32_t, std::int32_t>& kernels_for<std::int32_t, std::int32_t>(Isa isa)
+{
+    static const SimdKernels<int, int> scalar = { axpy_scalar<int, int>, microkernel_scalar<int, int> };
+#ifdef CAMM_X86
+    static const SimdKernels<int, int> sse41  = { axpy_i32_sse41,  microkernel_i32_sse41 };
+    static const SimdKernels<int, int> avx2   = { axpy_i32_avx2,   microkernel_i32_avx2 };
+    static const SimdKernels<int, int> avx512 = { axpy_i32_avx512, microkernel_i32_avx512 };
+
+    switch (isa) {
+        case Isa::AVX512: return avx512;
+        case Isa::AVX2:   return avx2;
+        case Isa::SSE41:  return sse41;
+        default:          break;
+    }
+#else
+    (void)isa;
+#endif
+    return scalar;
+}
+
+// float / double keep the generic axpy but use the FMA microkernels.
+template <>
+const SimdKernels<float, float>& kernels_for<float, float>(Isa isa)
+{
+    static const SimdKernels<float, float> scalar = { axpy_scalar<float, float>, microkernel_scalar<float, float> };
+#ifdef CAMM_X86
+    static const SimdKernels<float, float> sse41  = { axpy_sse41<float, float>,  microkernel_sse41<float, float> };
+    static const SimdKernels<float, float> avx2   = { axpy_avx2<float, float>,   microkernel_f32_avx2 };
+    static const SimdKernels<float, float> avx512 = { axpy_avx512<float, float>, microkernel_f32_avx512 };
+
+    switch (isa) {
+        case Isa::AVX512: return avx512;
+        case Isa::AVX2:   return avx2;
+        case Isa::SSE41:  return sse41;
+        default:          break;
+    }
+#else
+    (void)isa;
+#endif
+    return scalar;
+}
+
+template <>
+const SimdKernels<double, double>& kernels_for<double, double>(Isa isa)
+{
+    static const SimdKernels<double, double> scalar = { axpy_scalar<double, double>, microkernel_scalar<double, double> };
+#ifdef CAMM_X86
+    static const SimdKernels<double, double> sse41  = { axpy_sse41<double, double>,  microkernel_sse41<double, double> };
+    static const SimdKernels<double, double> avx2   = { axpy_avx2<double, double>,   microkernel_f64_avx2 };
+    static const SimdKernels<double, double> avx512 = { axpy_avx512<double, double>, microkernel_f64_avx512 };
+
+    switch (isa) {
+        case Isa::AVX512: return avx512;
+        case Isa::AVX2:   return avx2;
+        case Isa::SSE41:  return sse41;
+        default:          break;
+    }
+#else
+    (void)isa;
+#endif
+    return scalar;
+}
+
+// -1 = not chosen yet; otherwise the Isa value in use.
+static std::atomic<int> activeIsa{-1};
+
+bool set_active_isa(Isa isa)
+{
+    if (!isa_supported(isa))
+        return false;
+    activeIsa.store(static_cast<int>(isa));
+    return true;
+}
+
+Isa active_isa()
+{
+    int current = activeIsa.load();
+    if (current < 0) {
+        current = static_cast<int>(detect_isa());
+        activeIsa.store(current);
+    }
+    return static_cast<Isa>(current);
+}
+
+template <typename T, typename Acc>
+const SimdKernels<T, Acc>& simd_kernels()
+{
+    return kernels_for<T, Acc>(active_isa());
+}
+
+// One table row per ISA, one entry per SMALL_GEMM_EDGES edge.
+#define CAMM_SMALL_GEMM_ROW(suffix)                                                        \
+    { small_gemm_##suffix<3, T, Acc>, small_gemm_##suffix<4, T, Acc>,                     \
+      small_gemm_##suffix<8, T, Acc>, small_gemm_##suffix<16, T, Acc>,                    \
+      small_gemm_##suffix<32, T, Acc>, small_gemm_##suffix<64, T, Acc> }
+
+/**
+ * Largest edge whose fixed-size kernel beats single-task packed_gemm on the
+ * given ISA. Measured: int8 inputs tie packed (pmaddwd) at 32 and lose at 64
+ * under AVX-512; 64-bit integer products have no vector multiply below
+ * AVX-512, so from 16 up the scalar packed kernel wins there.
+ */
+template <typename T, typename Acc>
+static int fixed_kernel_max_edge(Isa isa)
+{
+    if (sizeof(T) == 1 && isa == Isa::AVX512)
+        return 16;
+    if (sizeof(Acc) == 8 && !std::is_floating_point<Acc>::value && isa != Isa::AVX512 && isa != Isa::AVX2)
+        return 8;
+    return 64;
+}
+
+template <typename T, typename Acc>
+SmallGemmKernel<T, Acc> small_gemm_kernel(int n)
+{
+    constexpr int count = static_cast<int>(sizeof(SMALL_GEMM_EDGES) / sizeof(SMALL_GEMM_EDGES[0]));
+    static_assert(count == 6, "CAMM_SMALL_GEMM_ROW lists every edge");
+    int slot = 0;
+    while (slot < count && SMALL_GEMM_EDGES[slot] != n)
+        ++slot;
+    if (slot == count || n > fixed_kernel_max_edge<T, Acc>(active_isa()))
+        return nullptr;
+
+    static const SmallGemmKernel<T, Acc> scalar[count] = CAMM_SMALL_GEMM_ROW(scalar);
+#ifdef CAMM_X86
+    static const SmallGemmKernel<T, Acc> sse41[count]  = CAMM_SMALL_GEMM_ROW(sse41);
+    static const SmallGemmKernel<T, Acc> avx2[count]   = CAMM_SMALL_GEMM_ROW(avx2);
+    static const SmallGemmKernel<T, Acc> avx512[count] = CAMM_SMALL_GEMM_ROW(avx512);
+
+    switch (active_isa()) {
+        case Isa::AVX512: return avx512[slot];
+        case Isa::AVX2:   return avx2[slot];
+        case Isa::SSE41:  return sse41[slot];
+        default:          break;
+    }
+#endif
+    return scalar[slot];
+}
+
+template <typename T, typename Acc>
+bool try_fixed_matmul(int M, int N, int K, const T* A, int lda, const T* B, int ldb, Acc* C, int ldc)
+{
+    if (M != N || N != K)
+        return false;
+    SmallGemmKernel<T, Acc> kernel = small_gemm_kernel<T, Acc>(M);
+    if (!kernel)
+        return false;
+    kernel(A, lda, B, ldb, C, ldc);
+    return true;
+}
+
+#define CAMM_INSTANTIATE_SIMD_KERNELS(T, Acc)                                              \
+    template const SimdKernels<T, Acc>& simd_kernels<T, Acc>();                           \
+    template SmallGemmKernel<T, Acc> small_gemm_kernel<T, Acc>(int);                      \
+    template bool try_fixed_matmul<T, Acc>(int, int, int, const T*, int, const T*, int,   \
+                                           Acc*, int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_SIMD_KERNELS)
+// Also used by packed_gemm<int64, int64> under Strassen.
+CAMM_INSTANTIATE_SIMD_KERNELS(std::int64_t, std::int64_t)
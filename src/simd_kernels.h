@@ -0,0 +1,63 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <string>
+
+// Instruction sets with a hand-written int32 kernel, ordered narrowest to widest.
+enum class Isa {
+    Scalar,
+    SSE41,
+    AVX2,
+    AVX512
+};
+
+const char* isa_name(Isa isa);
+bool parse_isa(const std::string& name, Isa& out);
+
+// Widest ISA supported by both the CPU (CPUID) and the OS (XGETBV).
+Isa detect_isa();
+bool isa_supported(Isa isa);
+
+// The kernel table used by every matmul. Defaults to detect_isa() on first use;
+// set_active_isa() overrides it (returns false if the host cannot run that ISA).
+bool set_active_isa(Isa isa);
+Isa active_isa();
+
+// Kernels for one input / accumulator type pair (see matmul_types.h).
+// int32 has hand-written intrinsics and float/double hand-written FMA
+// microkernels; everything else uses the generic loops compiled once per ISA,
+// so the auto-vectorizer can use the wider registers.
+template <typename T, typename Acc>
+struct SimdKernels {
+    // c[0..n) += a * b[0..n)  -- the inner loop of every i-k-j kernel
+    void (*axpy)(Acc* c, const T* b, Acc a, int n);
+
+    // C[PACK_MR x PACK_NR] += Ap * Bp over kc packed steps (see packed_matmul.h)
+    void (*microkernel)(int kc, const T* Ap, const T* Bp, Acc* C, int ldc);
+};
+
+template <typename T, typename Acc>
+const SimdKernels<T, Acc>& simd_kernels();
+
+// Square edges with a fixed-size kernel: matmul<E, E, E> from fixed_matmul.h,
+// compiled once per ISA. Used by the batched API (batched_matmul.h) and by
+// every runtime entry point through try_fixed_matmul.
+constexpr int SMALL_GEMM_EDGES[] = { 3, 4, 8, 16, 32, 64 };
+
+// C[n x n] += A[n x n] * B[n x n], row-major with leading dimensions.
+template <typename T, typename Acc>
+using SmallGemmKernel = void (*)(const T* A, int lda, const T* B, int ldb, Acc* C, int ldc);
+
+// The active ISA's kernel for n x n x n, or nullptr if n is not in
+// SMALL_GEMM_EDGES or packed GEMM measured faster for that type and ISA.
+template <typename T, typename Acc>
+SmallGemmKernel<T, Acc> small_gemm_kernel(int n);
+
+// C(MxN) += A(MxK) * B(KxN) with the fixed-size kernel when M == N == K has
+// one (small_gemm_kernel); returns false, having done nothing, otherwise.
+// The runtime matmuls try it first, so small products skip their blocking,
+// packing and task dispatch.
+template <typename T, typename Acc>
+bool try_fixed_matmul(int M, int N, int K, const T* A, int lda, const T* B, int ldb, Acc* C, int ldc);
+
+#endif // SIMD_KERNELS_H
@@ -0,0 +1,318 @@
+#include "strassen_matmul.h"
+#include "packed_matmul.h"
+#include "simd_kernels.h"
+#include "matmul_types.h"
+#include "buffer_pool.h"
+#include "tuning.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+// Default crossover, measured with tune_strassen_crossover on an AVX-512 machine
+// (f32/f64/i32 break even around 512-1024): below it the extra additions cost
+// more than the saved product. Run --strassen-tune or --tune to measure it
+// elsewhere; the result is kept in the tuning table under the large class.
+constexpr int DEFAULT_CROSSOVER = 512;
+
+// Integer sums wrap (computed unsigned), which keeps them exact modulo 2^bits
+// like the classical kernels instead of being undefined on overflow.
+template <typename U>
+inline U add(U a, U b)
+{
+    if constexpr (std::is_integral<U>::value) {
+        using Unsigned = std::make_unsigned_t<U>;
+        return static_cast<U>(static_cast<Unsigned>(a) + static_cast<Unsigned>(b));
+    } else {
+        return a + b;
+    }
+}
+
+template <typename U>
+inline U sub(U a, U b)
+{
+    if constexpr (std::is_integral<U>::value) {
+        using Unsigned = std::make_unsigned_t<U>;
+        return static_cast<U>(static_cast<Unsigned>(a) - static_cast<Unsigned>(b));
+    } else {
+        return a - b;
+    }
+}
+
+// dst = x + y, dst = x - y and dst += x over equally sized views (dst may alias x).
+template <typename U>
+void add_into(MatrixView<U> dst, MatrixView<const U> x, MatrixView<const U> y)
+{
+    for (int i = 0; i < dst.rows(); ++i) {
+        U* d = dst.row(i);
+        const U* a = x.row(i);
+        const U* b = y.row(i);
+        for (int j = 0; j < dst.cols(); ++j)
+            d[j] = add(a[j], b[j]);
+    }
+}
+
+template <typename U>
+void sub_into(MatrixView<U> dst, MatrixView<const U> x, MatrixView<const U> y)
+{
+    for (int i = 0; i < dst.rows(); ++i) {
+        U* d = dst.row(i);
+        const U* a = x.row(i);
+        const U* b = y.row(i);
+        for (int j = 0; j < dst.cols(); ++j)
+            d[j] = sub(a[j], b[j]);
+    }
+}
+
+template <typename U>
+void accumulate(MatrixView<U> dst, MatrixView<const U> x)
+{
+    for (int i = 0; i < dst.rows(); ++i) {
+        U* d = dst.row(i);
+        const U* a = x.row(i);
+        for (int j = 0; j < dst.cols(); ++j)
+            d[j] = add(d[j], a[j]);
+    }
+}
+
+template <typename U>
+void zero(MatrixView<U> dst)
+{
+    for (int i = 0; i < dst.rows(); ++i)
+        std::memset(dst.row(i), 0, static_cast<std::size_t>(dst.cols()) * sizeof(U));
+}
+
+// Stack-like scratch space: every level takes its temporaries on entry and
+// releases them on exit, so one buffer sized by arena_elems serves the whole call.
+template <typename U>
+class ScratchArena {
+public:
+    explicit ScratchArena(std::size_t elems)
+        : data_(static_cast<U*>(acquire_buffer(std::max<std::size_t>(elems, 1) * sizeof(U), false))) {}
+    ~ScratchArena() { release_buffer(data_); }
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    MatrixView<U> take(int rows, int cols) {
+        int ld = padded_ld<U>(cols);
+        MatrixView<U> view(data_ + used_, rows, cols, ld);
+        used_ += static_cast<std::size_t>(rows) * ld;
+        return view;
+    }
+
+    std::size_t mark() const { return used_; }
+    void release(std::size_t mark) { used_ = mark; }
+
+private:
+    U* data_;
+    std::size_t used_ = 0;
+};
+
+template <typename U>
+std::size_t view_elems(int rows, int cols)
+{
+    return static_cast<std::size_t>(rows) * padded_ld<U>(cols);
+}
+
+bool is_base_case(int M, int K, int N, int crossover)
+{
+    return std::min({ M, K, N }) <= crossover;
+}
+
+// Scratch needed by strassen_recursive on an M x K x N product: S, T and P of
+// this level plus whatever one (same-sized) child needs, since children run one at a time.
+template <typename U>
+std::size_t arena_elems(int M, int K, int N, int crossover)
+{
+    if (is_base_case(M, K, N, crossover))
+        return 0;
+    int hm = M / 2, hk = K / 2, hn = N / 2;
+    return view_elems<U>(hm, hk) + view_elems<U>(hk, hn) + view_elems<U>(hm, hn)
+         + arena_elems<U>(hm, hk, hn, crossover);
+}
+
+template <typename U>
+void base_multiply(MatrixView<const U> A, MatrixView<const U> B, MatrixView<U> C, int threadCount)
+{
+    packed_matmul<U, U>(A, B, C, threadCount);
+}
+
+/**
+ * One Strassen-Winograd level on the even part of the problem, scheduled so
+ * only three temporaries (S, T, P) are live and products that feed a single
+ * quadrant accumulate straight into C:
+ *   S1 = A21 + A22   S2 = S1 - A11   S3 = A11 - A21   S4 = A12 - S2
+ *   T1 = B12 - B11   T2 = B22 - T1   T3 = B22 - B12   T4 = T2 - B21
+ *   C11 += M1 + M2               C12 += M1 + M6 + M5 + M3
+ *   C21 += M1 + M6 + M7 - M4     C22 += M1 + M6 + M7 + M5
+ * The odd last row / column / inner index are peeled and added with thin
+ * packed products.
+ */
+template <typename U>
+void strassen_recursive(MatrixView<const U> A, MatrixView<const U> B, MatrixView<U> C,
+                        ScratchArena<U>& arena, int crossover, int threadCount)
+{
+    int M = C.rows(), N = C.cols(), K = A.cols();
+    if (is_base_case(M, K, N, crossover)) {
+        base_multiply(A, B, C, threadCount);
+        return;
+    }
+
+    int hm = M / 2, hk = K / 2, hn = N / 2;
+    int m2 = 2 * hm, k2 = 2 * hk, n2 = 2 * hn;
+
+    MatrixView<const U> A11 = A.block(0, 0, hm, hk),  A12 = A.block(0, hk, hm, hk);
+    MatrixView<const U> A21 = A.block(hm, 0, hm, hk), A22 = A.block(hm, hk, hm, hk);
+    MatrixView<const U> B11 = B.block(0, 0, hk, hn),  B12 = B.block(0, hn, hk, hn);
+    MatrixView<const U> B21 = B.block(hk, 0, hk, hn), B22 = B.block(hk, hn, hk, hn);
+    MatrixView<U> C11 = C.block(0, 0, hm, hn),  C12 = C.block(0, hn, hm, hn);
+    MatrixView<U> C21 = C.block(hm, 0, hm, hn), C22 = C.block(hm, hn, hm, hn);
+
+    std::size_t mark = arena.mark();
+    MatrixView<U> S = arena.take(hm, hk);
+    MatrixView<U> T = arena.take(hk, hn);
+    MatrixView<U> P = arena.take(hm, hn);
+
+    auto recurse = [&](MatrixView<const U> X, MatrixView<const U> Y, MatrixView<U> Z) {
+        strassen_recursive<U>(X, Y, Z, arena, crossover, threadCount);
+    };
+
+    // M5 = S1 * T1 -> C12, C22
+    add_into<U>(S, A21, A22);
+    sub_into<U>(T, B12, B11);
+    zero(P);
+    recurse(S, T, P);
+    accumulate<U>(C12, P);
+    accumulate<U>(C22, P);
+
+    // P = M1 -> C11, then P = M1 + M6 -> C12
+    sub_into<U>(S, S, A11);
+    sub_into<U>(T, B22, T);
+    zero(P);
+    recurse(A11, B11, P);
+    accumulate<U>(C11, P);
+    recurse(S, T, P);
+    accumulate<U>(C12, P);
+
+    // M2 -> C11
+    recurse(A12, B21, C11);
+
+    // M3 = S4 * B22 -> C12
+    sub_into<U>(S, A12, S);
+    recurse(S, B22, C12);
+
+    // -M4 = A22 * (B21 - T2) -> C21
+    sub_into<U>(T, B21, T);
+    recurse(A22, T, C21);
+
+    // P = M1 + M6 + M7 -> C21, C22
+    sub_into<U>(S, A11, A21);
+    sub_into<U>(T, B22, B12);
+    recurse(S, T, P);
+    accumulate<U>(C21, P);
+    accumulate<U>(C22, P);
+
+    arena.release(mark);
+
+    // Peeling: the last inner index, then the last column and row of C in full.
+    if (K > k2)
+        base_multiply<U>(A.block(0, k2, m2, 1), B.block(k2, 0, 1, n2), C.block(0, 0, m2, n2), threadCount);
+    if (N > n2)
+        base_multiply<U>(A, B.block(0, n2, K, 1), C.block(0, n2, M, 1), threadCount);
+    if (M > m2)
+        base_multiply<U>(A.block(m2, 0, 1, K), B.block(0, 0, K, n2), C.block(m2, 0, 1, n2), threadCount);
+}
+
+// Copies a T view into Acc storage taken from the arena.
+template <typename T, typename Acc>
+MatrixView<const Acc> widen(MatrixView<const T> src, ScratchArena<Acc>& arena)
+{
+    MatrixView<Acc> dst = arena.take(src.rows(), src.cols());
+    for (int i = 0; i < src.rows(); ++i)
+        std::copy(src.row(i), src.row(i) + src.cols(), dst.row(i));
+    return dst;
+}
+
+} // namespace
+
+template <typename T, typename Acc>
+int strassen_crossover()
+{
+    return tuned_value(TuneKey::StrassenCrossover, dtype_of<T, Acc>(), ShapeClass::Large,
+                       DEFAULT_CROSSOVER);
+}
+
+/**
+ * Sums are formed in Acc, so narrow inputs (int8/int16 -> int32, int32 ->
+ * int64) are widened once up front and the recursion runs on Acc x Acc.
+ */
+template <typename T, typename Acc>
+void strassen_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                     int threadCount, int crossover)
+{
+    int M = C.rows(), N = C.cols(), K = A.cols();
+    if (C.empty() || K <= 0)
+        return;
+    if (try_fixed_matmul<T, Acc>(M, N, K, A.data(), A.ld(), B.data(), B.ld(), C.data(), C.ld()))
+        return;
+    if (crossover <= 0)
+        crossover = strassen_crossover<T, Acc>();
+
+    std::size_t elems = arena_elems<Acc>(M, K, N, crossover);
+    if constexpr (!std::is_same<T, Acc>::value)
+        elems += view_elems<Acc>(M, K) + view_elems<Acc>(K, N);
+    ScratchArena<Acc> arena(elems);
+
+    if constexpr (std::is_same<T, Acc>::value) {
+        strassen_recursive<Acc>(A, B, C, arena, crossover, threadCount);
+    } else {
+        MatrixView<const Acc> Aw = widen<T, Acc>(A, arena);
+        MatrixView<const Acc> Bw = widen<T, Acc>(B, arena);
+        strassen_recursive<Acc>(Aw, Bw, C, arena, crossover, threadCount);
+    }
+}
+
+template <typename T, typename Acc>
+int tune_strassen_crossover(int threadCount, int maxCrossover)
+{
+    using Clock = std::chrono::steady_clock;
+    auto best_of = [](int reps, auto&& fn) {
+        double best = 1e300;
+        for (int r = 0; r < reps; ++r) {
+            auto start = Clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        }
+        return best;
+    };
+
+    int chosen = maxCrossover;
+    for (int c = 64; c <= maxCrossover; c *= 2) {
+        int n = 2 * c;
+        Matrix<T>   A(n, n, T(1));
+        Matrix<T>   B(n, n, T(1));
+        Matrix<Acc> C(n, n);
+
+        double packed = best_of(3, [&] { packed_matmul<T, Acc>(A, B, C, threadCount); });
+        // crossover = c: exactly one Strassen level above packed c x c products.
+        double strassen = best_of(3, [&] { strassen_matmul<T, Acc>(A, B, C, threadCount, c); });
+        if (strassen < packed) {
+            chosen = c;
+            break;
+        }
+    }
+
+    set_tuned_value(TuneKey::StrassenCrossover, dtype_of<T, Acc>(), ShapeClass::Large, chosen);
+    return chosen;
+}
+
+#define CAMM_INSTANTIATE_STRASSEN(T, Acc)                                                   \
+    template int strassen_crossover<T, Acc>();                                              \
+    template int tune_strassen_crossover<T, Acc>(int, int);                                 \
+    template void strassen_matmul<T, Acc>(MatrixView<const T>, MatrixView<const T>,         \
+                                          MatrixView<Acc>, int, int);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_STRASSEN)
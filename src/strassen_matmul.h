@@ -0,0 +1,29 @@
+#ifndef STRASSEN_MATMUL_H
+#define STRASSEN_MATMUL_H
+
+#include "matrix.h"
+
+// Crossover used when strassen_matmul is called with crossover = 0: products
+// whose smallest dimension is at or below it go to packed_gemm. Starts at a
+// measured default, or the value in the tuning file for this CPU;
+// tune_strassen_crossover replaces it for this process.
+template <typename T, typename Acc>
+int strassen_crossover();
+
+// Times one Strassen-Winograd level against plain packed_gemm on 2c x 2c
+// products for c = 64, 128, ..., maxCrossover, and keeps the smallest c at
+// which the extra level pays off. Returns the chosen crossover.
+template <typename T, typename Acc>
+int tune_strassen_crossover(int threadCount, int maxCrossover = 1024);
+
+// C += A * B with the Strassen-Winograd recursion (7 half-size products and
+// 14 half-size additions per level) down to the crossover, then packed_gemm
+// with threadCount tasks. Odd dimensions are peeled off and fixed up with thin
+// packed products. All temporaries come from one arena allocated up front.
+// Sums are formed in Acc, with wrap-around for integers, so integer results
+// are exactly those of the classical algorithm.
+template <typename T, typename Acc>
+void strassen_matmul(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+                     int threadCount, int crossover = 0);
+
+#endif // STRASSEN_MATMUL_H
@@ -0,0 +1,231 @@
+#include "task_scheduler.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace {
+
+// Which scheduler (if any) the current thread is a worker of, and its index.
+thread_local TaskScheduler* currentScheduler = nullptr;
+thread_local int currentWorker = -1;
+
+// The process-wide pool. `pool` is the lock-free fast path for instance();
+// `poolOwner` keeps it alive and joins it at exit.
+std::mutex poolMutex;
+std::atomic<TaskScheduler*> pool{nullptr};
+std::unique_ptr<TaskScheduler> poolOwner;
+int configuredWorkers = 0;
+Affinity configuredAffinity = Affinity::None;
+
+int default_worker_count()
+{
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+} // namespace
+
+TaskScheduler::TaskScheduler(int workerCount, Affinity affinity)
+    : cpuOrder_(affinity_cpu_order(affinity)), affinity_(affinity)
+{
+    workerCount = std::max(1, workerCount);
+    for (int i = 0; i <= workerCount; ++i)
+        queues_.push_back(std::make_unique<TaskQueue>());
+
+    threads_.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i)
+        threads_.emplace_back(&TaskScheduler::worker_loop, this, i);
+
+    // Wait until every worker is running (and pinned), so pinned_workers() is final.
+    while (started_.load() < workerCount)
+        std::this_thread::yield();
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &th : threads_)
+        th.join();
+}
+
+TaskScheduler& TaskScheduler::instance()
+{
+    if (TaskScheduler* scheduler = pool.load(std::memory_order_acquire))
+        return *scheduler;
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (!poolOwner) {
+        poolOwner = std::make_unique<TaskScheduler>(
+            configuredWorkers > 0 ? configuredWorkers : default_worker_count(), configuredAffinity);
+        pool.store(poolOwner.get(), std::memory_order_release);
+    }
+    return *poolOwner;
+}
+
+void TaskScheduler::configure(int workerCount, Affinity affinity)
+{
+    std::unique_ptr<TaskScheduler> old;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        configuredWorkers = std::max(0, workerCount);
+        configuredAffinity = affinity;
+        int wanted = configuredWorkers > 0 ? configuredWorkers : default_worker_count();
+        if (poolOwner && (poolOwner->worker_count() != wanted || poolOwner->affinity() != affinity)) {
+            pool.store(nullptr, std::memory_order_release);
+            old = std::move(poolOwner);
+        }
+    }
+    // Joined outside the lock so a worker calling instance() cannot deadlock.
+}
+
+void TaskScheduler::shutdown()
+{
+    std::unique_ptr<TaskScheduler> old;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        pool.store(nullptr, std::memory_order_release);
+        old = std::move(poolOwner);
+    }
+}
+
+/**
+ * Workers push onto their own deque; any other thread uses the injection queue.
+ */
+void TaskScheduler::push(Task task)
+{
+    std::size_t index = (currentScheduler == this) ? static_cast<std::size_t>(currentWorker)
+                                                   : queues_.size() - 1;
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1);
+
+    // Taking the lock orders this notify after a sleeper's predicate check.
+    { std::lock_guard<std::mutex> lock(sleepMutex_); }
+    wake_.notify_one();
+}
+
+/**
+ * Own deque (back) first, then the injection queue, then steal (front)
+ * from the other workers starting after our own index.
+ */
+bool TaskScheduler::try_pop(Task& out)
+{
+    if (queued_.load() == 0)
+        return false;
+
+    const int workers = worker_count();
+    const int self = (currentScheduler == this) ? currentWorker : -1;
+
+    if (self >= 0) {
+        TaskQueue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (int offset = 0; offset <= workers; ++offset) {
+        // offset 0 is the injection queue, the rest walk round the workers.
+        int victim = (offset == 0) ? workers : (std::max(self, 0) + offset) % workers;
+        if (victim == self)
+            continue;
+        TaskQueue& queue = *queues_[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            out = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * A group task always counts down its group, even if fn throws; the exception
+ * goes to the group for wait() to rethrow. A post() task has nobody to report
+ * to, and letting it unwind would hand it to whichever wait() ran it.
+ */
+void TaskScheduler::run(Task& task)
+{
+    try {
+        task.fn();
+    } catch (...) {
+        if (!task.group)
+            std::terminate();
+        task.group->fail(std::current_exception());
+    }
+    if (task.group)
+        task.group->pending_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void TaskScheduler::post(std::function<void()> fn)
+{
+    push(Task{std::move(fn), nullptr});
+}
+
+void TaskScheduler::worker_loop(int index)
+{
+    currentScheduler = this;
+    currentWorker = index;
+    if (!cpuOrder_.empty() && pin_current_thread(cpuOrder_[index % cpuOrder_.size()]))
+        pinned_.fetch_add(1);
+    started_.fetch_add(1);
+
+    Task task;
+    for (;;) {
+        if (try_pop(task)) {
+            run(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+        if (stop_ && queued_.load() == 0)
+            return;
+    }
+}
+
+void TaskGroup::spawn(std::function<void()> fn)
+{
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    scheduler_.push(TaskScheduler::Task{std::move(fn), this});
+}
+
+void TaskGroup::wait()
+{
+    drain();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        std::swap(error, error_);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void TaskGroup::drain()
+{
+    TaskScheduler::Task task;
+    while (pending_.load(std::memory_order_acquire) > 0) {
+        if (scheduler_.try_pop(task))
+            scheduler_.run(task);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void TaskGroup::fail(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    if (!error_)
+        error_ = std::move(error);
+}
@@ -0,0 +1,135 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "thread_affinity.h"
+
+class TaskGroup;
+
+// Work-stealing fork-join scheduler.
+// Every worker owns a deque: it pushes and pops its own tasks at the back
+// (LIFO, so the most recently split -- cache-hot -- subproblem runs next) and
+// idle workers steal from the front of other deques (FIFO, the largest pieces).
+// Threads outside the pool submit through a shared injection queue.
+class TaskScheduler {
+public:
+    // Worker i is pinned to affinity_cpu_order(affinity)[i] (wrapping around).
+    explicit TaskScheduler(int workerCount, Affinity affinity = Affinity::None);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    int worker_count() const { return static_cast<int>(threads_.size()); }
+    Affinity affinity() const { return affinity_; }
+    // Workers whose pin_current_thread succeeded (0 for Affinity::None).
+    int pinned_workers() const { return pinned_.load(); }
+
+    // Process-wide pool, started on first use with the configured size and
+    // shared by every parallel kernel, so no call pays for thread creation.
+    static TaskScheduler& instance();
+
+    // Size and placement of the process-wide pool; 0 workers means one per
+    // hardware thread. If the pool is already running with other settings it
+    // is shut down and restarted lazily. Must not be called while tasks are in flight.
+    static void configure(int workerCount, Affinity affinity = Affinity::None);
+
+    // Joins the process-wide pool's workers. The next instance() starts a new one.
+    // Also done automatically at exit.
+    static void shutdown();
+
+    // Queues fn outside any TaskGroup: nobody waits for it, so fn has to
+    // publish its own completion and errors (async_matmul.h uses it for job
+    // tiles). An exception escaping fn terminates the process.
+    void post(std::function<void()> fn);
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group;   // nullptr for post()
+    };
+
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task);
+    bool try_pop(Task& out);
+    void run(Task& task);
+    void worker_loop(int index);
+
+    // queues_[0..workers) belong to the workers, queues_.back() is the injection queue.
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::vector<int> cpuOrder_;
+    Affinity affinity_;
+    std::atomic<int> pinned_{0};
+    std::atomic<int> started_{0};
+
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<int> queued_{0};
+    bool stop_ = false;
+};
+
+// A set of tasks that are waited on together.
+// wait() does not block idly: the waiting thread keeps running queued tasks
+// (its own first, then stolen ones) until every task of the group has finished.
+// A task that throws still counts as finished; wait() rethrows the first such
+// exception once the whole group has drained. The destructor drains without
+// rethrowing, so unwinding past a group never leaves its tasks running.
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::instance())
+        : scheduler_(scheduler) {}
+    ~TaskGroup() { drain(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void spawn(std::function<void()> fn);
+    void wait();
+
+private:
+    friend class TaskScheduler;
+
+    void drain();
+    void fail(std::exception_ptr error);
+
+    TaskScheduler& scheduler_;
+    std::atomic<int> pending_{0};
+    std::mutex errorMutex_;
+    std::exception_ptr error_;   // first exception thrown by a task
+};
+
+// Runs fn(0) .. fn(count - 1) on the process-wide pool and returns when all
+// are done. The calling thread runs fn(0) itself and then helps with the rest.
+// If any call throws, the rest still finish and one of the exceptions is rethrown.
+template <typename Fn>
+void parallel_for(int count, Fn&& fn)
+{
+    if (count <= 1) {
+        if (count == 1)
+            fn(0);
+        return;
+    }
+    TaskGroup group;
+    for (int i = 1; i < count; ++i)
+        group.spawn([&fn, i] { fn(i); });
+    fn(0);
+    group.wait();
+}
+
+#endif // TASK_SCHEDULER_H
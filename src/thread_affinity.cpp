@@ -0,0 +1,102 @@
+#include "thread_affinity.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+const char* affinity_name(Affinity affinity)
+{
+    switch (affinity) {
+    case Affinity::Compact: return "compact";
+    case Affinity::Scatter: return "scatter";
+    default:                return "none";
+    }
+}
+
+bool parse_affinity(const std::string& name, Affinity& out)
+{
+    if (name == "none")    { out = Affinity::None;    return true; }
+    if (name == "compact") { out = Affinity::Compact; return true; }
+    if (name == "scatter") { out = Affinity::Scatter; return true; }
+    return false;
+}
+
+// Index of the last-level-cache group each CPU belongs to; the package id
+// when the topology has no sharing information.
+static std::map<int, int> llc_domains(const SystemTopology& topo)
+{
+    std::map<int, int> domain;
+    for (const CpuInfo& info : topo.cpus)
+        domain[info.cpu] = info.package;
+
+    int level = topo.last_level();
+    if (level > 0 && level < static_cast<int>(topo.cache_groups.size())) {
+        const auto& groups = topo.cache_groups[level];
+        for (std::size_t g = 0; g < groups.size(); ++g)
+            for (int cpu : groups[g])
+                domain[cpu] = static_cast<int>(g);
+    }
+    return domain;
+}
+
+/**
+ * Compact sorts by (socket, LLC domain, core, cpu). Scatter ranks every CPU
+ * among the SMT siblings of its core, orders each domain by (rank, core) so
+ * all physical cores come before any second hyperthread, then deals domains
+ * round-robin.
+ */
+std::vector<int> affinity_cpu_order(Affinity affinity)
+{
+    std::vector<int> order;
+    if (affinity == Affinity::None)
+        return order;
+
+    const SystemTopology& topo = system_topology();
+    std::vector<CpuInfo> cpus = topo.cpus;
+    std::map<int, int> domain = llc_domains(topo);
+
+    if (affinity == Affinity::Compact) {
+        std::sort(cpus.begin(), cpus.end(), [&](const CpuInfo& a, const CpuInfo& b) {
+            return std::make_tuple(a.package, domain[a.cpu], a.core, a.cpu)
+                 < std::make_tuple(b.package, domain[b.cpu], b.core, b.cpu);
+        });
+        for (const CpuInfo& info : cpus)
+            order.push_back(info.cpu);
+        return order;
+    }
+
+    std::map<std::pair<int, int>, int> siblingsSeen;
+    std::map<std::pair<int, int>, std::vector<std::tuple<int, int, int>>> domains; // -> (rank, core, cpu)
+    for (const CpuInfo& info : cpus) {
+        int rank = siblingsSeen[{ info.package, info.core }]++;
+        domains[{ info.package, domain[info.cpu] }].emplace_back(rank, info.core, info.cpu);
+    }
+    for (auto& entry : domains)
+        std::sort(entry.second.begin(), entry.second.end());
+
+    for (std::size_t i = 0; order.size() < cpus.size(); ++i) {
+        for (auto& entry : domains) {
+            if (i < entry.second.size())
+                order.push_back(std::get<2>(entry.second[i]));
+        }
+    }
+    return order;
+}
+
+bool pin_current_thread(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
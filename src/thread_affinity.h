@@ -0,0 +1,30 @@
+#ifndef THREAD_AFFINITY_H
+#define THREAD_AFFINITY_H
+
+#include <string>
+#include <vector>
+
+#include "cache_utils.h"
+
+// How pool workers are placed on logical CPUs.
+enum class Affinity {
+    None,       // leave placement to the OS
+    Compact,    // fill one last-level-cache domain (core by core, SMT siblings together) before the next
+    Scatter     // round-robin over last-level-cache domains, then physical cores, siblings last
+};
+
+const char* affinity_name(Affinity affinity);
+// Accepts "none", "compact" or "scatter".
+bool parse_affinity(const std::string& name, Affinity& out);
+
+// The order in which workers 0, 1, 2, ... are pinned (empty for Affinity::None).
+// Built from system_topology(): a domain is one instance of the last-level
+// cache (a socket or a CCX), so compact keeps neighbouring
+// workers -- which split the same product -- under one shared cache.
+std::vector<int> affinity_cpu_order(Affinity affinity);
+
+// Pins the calling thread to one logical CPU. Returns false where pinning is
+// unsupported or refused; the thread then just keeps running unpinned.
+bool pin_current_thread(int cpu);
+
+#endif // THREAD_AFFINITY_H
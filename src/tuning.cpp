@@ -0,0 +1,289 @@
+#include "tuning.h"
+#include "cache_utils.h"
+#include "task_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const TuneKey ALL_KEYS[] = {
+    TuneKey::CacheAwareBlock, TuneKey::Tile1D, TuneKey::Threads1D,
+    TuneKey::ObliviousCutoff, TuneKey::PackedThreads, TuneKey::StrassenCrossover
+};
+const ShapeClass ALL_CLASSES[] = { ShapeClass::Small, ShapeClass::Medium, ShapeClass::Large };
+const DType ALL_DTYPES[] = { DType::F32, DType::F64, DType::I8, DType::I16, DType::I32, DType::I64 };
+
+constexpr int KEY_COUNT = sizeof(ALL_KEYS) / sizeof(ALL_KEYS[0]);
+constexpr int DTYPE_COUNT = sizeof(ALL_DTYPES) / sizeof(ALL_DTYPES[0]);
+constexpr int CLASS_COUNT = sizeof(ALL_CLASSES) / sizeof(ALL_CLASSES[0]);
+
+// Every tuned value at one point in time; 0 means not tuned. Never changed
+// once published, so kernels read it without a lock.
+struct Snapshot {
+    int values[KEY_COUNT][DTYPE_COUNT][CLASS_COUNT] = {};
+    int count = 0;
+
+    int& at(TuneKey key, DType dtype, ShapeClass cls)
+    {
+        return values[static_cast<int>(key)][static_cast<int>(dtype)][static_cast<int>(cls)];
+    }
+};
+
+// Writers (loading, set_tuned_value) copy the current snapshot under the
+// mutex and publish the copy. Superseded snapshots are kept until exit, since
+// a kernel may still be reading one, so every write costs one Snapshot: load
+// once, then one per winner --tune stores. Candidates are passed to the
+// kernels directly and never go through the table.
+struct Table {
+    std::mutex mutex;
+    std::once_flag loaded;
+    std::atomic<const Snapshot*> current{nullptr};
+    std::vector<std::unique_ptr<Snapshot>> snapshots;
+};
+
+Table& table()
+{
+    static Table instance;
+    return instance;
+}
+
+void ensure_loaded()
+{
+    std::call_once(table().loaded, [] { load_tuning_file(tuning_file_path()); });
+}
+
+const Snapshot& snapshot()
+{
+    ensure_loaded();
+    static const Snapshot empty;
+    const Snapshot* current = table().current.load(std::memory_order_acquire);
+    return current ? *current : empty;
+}
+
+// Applies `edit` to a copy of the current snapshot and publishes it.
+template <typename Edit>
+void update(Edit&& edit)
+{
+    std::lock_guard<std::mutex> lock(table().mutex);
+    const Snapshot* current = table().current.load(std::memory_order_relaxed);
+    auto next = current ? std::make_unique<Snapshot>(*current) : std::make_unique<Snapshot>();
+    edit(*next);
+    table().current.store(next.get(), std::memory_order_release);
+    table().snapshots.push_back(std::move(next));
+}
+
+void store(Snapshot& snap, TuneKey key, DType dtype, ShapeClass cls, int value)
+{
+    int& slot = snap.at(key, dtype, cls);
+    if (slot == 0)
+        ++snap.count;
+    slot = value;
+}
+
+// Values handed to the kernels: tile edges and cutoffs up to 4096, task
+// counts up to 1024, and a Strassen crossover from 16 (smaller ones only
+// deepen the recursion) up to 2^16.
+struct Range {
+    int min;
+    int max;
+};
+
+Range tune_range(TuneKey key)
+{
+    switch (key) {
+    case TuneKey::Threads1D:
+    case TuneKey::PackedThreads:     return { 1, 1024 };
+    case TuneKey::StrassenCrossover: return { 16, 1 << 16 };
+    default:                         return { 1, 4096 };
+    }
+}
+
+template <typename Enum, std::size_t N>
+bool parse_name(const std::string& name, const Enum (&all)[N], const char* (*to_name)(Enum), Enum& out)
+{
+    for (Enum value : all) {
+        if (name == to_name(value)) {
+            out = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* dtype_label(DType dtype) { return dtype_name(dtype); }
+
+} // namespace
+
+const char* tune_key_name(TuneKey key)
+{
+    switch (key) {
+    case TuneKey::CacheAwareBlock:   return "cache_aware.block";
+    case TuneKey::Tile1D:            return "cache_aware_1D.tile";
+    case TuneKey::Threads1D:         return "cache_aware_1D.threads";
+    case TuneKey::ObliviousCutoff:   return "oblivious.cutoff";
+    case TuneKey::PackedThreads:     return "packed.threads";
+    case TuneKey::StrassenCrossover: return "strassen.crossover";
+    }
+    return "unknown";
+}
+
+const char* shape_class_name(ShapeClass cls)
+{
+    switch (cls) {
+    case ShapeClass::Small:  return "small";
+    case ShapeClass::Medium: return "medium";
+    case ShapeClass::Large:  return "large";
+    }
+    return "unknown";
+}
+
+ShapeClass shape_class(int M, int N, int K)
+{
+    int largest = std::max({ M, N, K });
+    if (largest <= 256)
+        return ShapeClass::Small;
+    if (largest <= 1024)
+        return ShapeClass::Medium;
+    return ShapeClass::Large;
+}
+
+int tuned_value(TuneKey key, DType dtype, ShapeClass cls, int fallback)
+{
+    int value = snapshot().values[static_cast<int>(key)][static_cast<int>(dtype)][static_cast<int>(cls)];
+    return value != 0 ? value : fallback;
+}
+
+int tuned_value(TuneKey key, DType dtype, int M, int N, int K, int fallback)
+{
+    return tuned_value(key, dtype, shape_class(M, N, K), fallback);
+}
+
+// Clamped into the key's range, so a caller cannot store a value the
+// kernels would reject either.
+void set_tuned_value(TuneKey key, DType dtype, ShapeClass cls, int value)
+{
+    ensure_loaded();
+    Range range = tune_range(key);
+    value = std::clamp(value, range.min, range.max);
+    update([&](Snapshot& snap) { store(snap, key, dtype, cls, value); });
+}
+
+int tuned_value_count()
+{
+    return snapshot().count;
+}
+
+int tuned_threads(TuneKey key, DType dtype, int M, int N, int K)
+{
+    return tuned_value(key, dtype, M, N, K, TaskScheduler::instance().worker_count());
+}
+
+std::string tuning_file_path()
+{
+    const char* path = std::getenv("CAMM_TUNING_FILE");
+    return (path && *path) ? path : "camm_tuning.txt";
+}
+
+/**
+ * Only the section whose header matches cpu_model_name() is applied; lines
+ * with unknown keys are skipped so older binaries can read newer files, and
+ * so are values outside the key's range (a hand-edited tile edge of 0 or a
+ * negative task count never reaches a kernel). The section is published as
+ * one snapshot.
+ */
+int load_tuning_file(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+        return -1;
+
+    struct Loaded {
+        TuneKey key;
+        DType dtype;
+        ShapeClass cls;
+        int value;
+    };
+    std::vector<Loaded> loaded;
+
+    const std::string model = "[" + cpu_model_name() + "]";
+    bool inSection = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        if (line[0] == '[') {
+            inSection = (line == model);
+            continue;
+        }
+        if (!inSection)
+            continue;
+
+        std::istringstream fields(line);
+        std::string keyName, dtypeName, className;
+        int value = 0;
+        TuneKey key;
+        DType dtype;
+        ShapeClass cls;
+        if (!(fields >> keyName >> dtypeName >> className >> value) ||
+            !parse_name(keyName, ALL_KEYS, tune_key_name, key) ||
+            !parse_name(dtypeName, ALL_DTYPES, dtype_label, dtype) ||
+            !parse_name(className, ALL_CLASSES, shape_class_name, cls))
+            continue;
+        Range range = tune_range(key);
+        if (value < range.min || value > range.max)
+            continue;
+
+        loaded.push_back({ key, dtype, cls, value });
+    }
+
+    update([&](Snapshot& snap) {
+        for (const Loaded& entry : loaded)
+            store(snap, entry.key, entry.dtype, entry.cls, entry.value);
+    });
+    return static_cast<int>(loaded.size());
+}
+
+bool save_tuning_file(const std::string& path)
+{
+    const std::string model = "[" + cpu_model_name() + "]";
+
+    // Keep every other model's section as it is.
+    std::vector<std::string> kept;
+    {
+        std::ifstream in(path);
+        bool inSection = false;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line[0] == '[')
+                inSection = (line == model);
+            if (!inSection && !(line.empty() || line[0] == '#'))
+                kept.push_back(line);
+        }
+    }
+
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out << "# cache_matmul tuning file, written by --tune: key dtype shape-class value\n";
+    for (const std::string& line : kept)
+        out << line << "\n";
+
+    out << model << "\n";
+    const Snapshot& snap = snapshot();
+    for (TuneKey key : ALL_KEYS)
+        for (DType dtype : ALL_DTYPES)
+            for (ShapeClass cls : ALL_CLASSES) {
+                int value = snap.values[static_cast<int>(key)][static_cast<int>(dtype)][static_cast<int>(cls)];
+                if (value != 0)
+                    out << tune_key_name(key) << " " << dtype_name(dtype) << " "
+                        << shape_class_name(cls) << " " << value << "\n";
+            }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,53 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include "matmul_types.h"
+
+#include <string>
+
+// Parameters that --tune measures instead of guessing.
+enum class TuneKey {
+    CacheAwareBlock,    // tile edge of cache_aware_matmul
+    Tile1D,             // tile edge of cache_aware_matmul_1D
+    Threads1D,          // task count for cache_aware_matmul_1D
+    ObliviousCutoff,    // base-case edge of the cache-oblivious recursion
+    PackedThreads,      // task count for packed GEMM
+    StrassenCrossover   // see strassen_crossover
+};
+
+// Problems are tuned per shape class of their largest dimension.
+enum class ShapeClass {
+    Small,      // up to 256
+    Medium,     // up to 1024
+    Large       // above
+};
+
+const char* tune_key_name(TuneKey key);
+const char* shape_class_name(ShapeClass cls);
+ShapeClass shape_class(int M, int N, int K);
+
+// Tuned value for (key, dtype, shape class of M x K x N), or `fallback` if
+// none was tuned. The first lookup loads tuning_file_path() for this CPU model;
+// after that a lookup reads an immutable snapshot without locking.
+// set_tuned_value clamps into the key's valid range.
+int tuned_value(TuneKey key, DType dtype, int M, int N, int K, int fallback);
+int tuned_value(TuneKey key, DType dtype, ShapeClass cls, int fallback);
+void set_tuned_value(TuneKey key, DType dtype, ShapeClass cls, int value);
+// Number of tuned values in effect (loading the file first if needed).
+int tuned_value_count();
+
+// Task count for a parallel kernel: the tuned value, else one per pool worker.
+int tuned_threads(TuneKey key, DType dtype, int M, int N, int K);
+
+// $CAMM_TUNING_FILE, or camm_tuning.txt in the working directory.
+std::string tuning_file_path();
+
+// The file holds one "[cpu model]" section per machine type, each with
+// "key dtype class value" lines. Loading reads only the section for
+// cpu_model_name() and returns how many values it accepted (-1 if the file
+// cannot be read); out-of-range values are skipped. Saving rewrites this
+// model's section and keeps the others.
+int load_tuning_file(const std::string& path);
+bool save_tuning_file(const std::string& path);
+
+#endif // TUNING_H
@@ -0,0 +1,151 @@
+#include "verify.h"
+#include "matmul_types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+template <typename T, typename Acc, typename Rng>
+void fill_bounded(Matrix<T>& M, int depth, Rng& rng)
+{
+    // |a| <= m with depth * m^2 * 64 <= max(Acc): room for the Strassen sums.
+    double headroom = double(std::numeric_limits<Acc>::max()) / (64.0 * std::max(depth, 1));
+    long long m = static_cast<long long>(std::sqrt(headroom));
+    m = std::max(1LL, std::min<long long>(m, std::numeric_limits<T>::max()));
+    std::uniform_int_distribution<long long> dist(-m, m);
+    for (int i = 0; i < M.rows(); ++i)
+        for (int j = 0; j < M.cols(); ++j)
+            M(i, j) = static_cast<T>(dist(rng));
+}
+
+template <typename T, typename Acc, typename Rng>
+void fill_random(Matrix<T>& M, int depth, Rng& rng)
+{
+    if constexpr (std::is_floating_point<T>::value) {
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (int i = 0; i < M.rows(); ++i)
+            for (int j = 0; j < M.cols(); ++j)
+                M(i, j) = static_cast<T>(dist(rng));
+    } else {
+        fill_bounded<T, Acc>(M, depth, rng);
+    }
+}
+
+// Integer accumulators: exact modulo 2^bits, computed unsigned so the check
+// itself cannot overflow.
+template <typename T, typename Acc, typename Rng>
+VerifyResult check_exact(MatrixView<const T> A, MatrixView<const T> B, MatrixView<const Acc> C,
+                         int rounds, Rng& rng)
+{
+    using U = std::make_unsigned_t<Acc>;
+    const int M = A.rows(), K = A.cols(), N = B.cols();
+    std::uniform_int_distribution<U> dist;
+    std::vector<U> r(N), br(K);
+
+    VerifyResult result;
+    for (int round = 0; round < rounds; ++round) {
+        for (U& x : r)
+            x = dist(rng);
+        for (int k = 0; k < K; ++k) {
+            U sum = 0;
+            for (int j = 0; j < N; ++j)
+                sum += static_cast<U>(static_cast<Acc>(B(k, j))) * r[j];
+            br[k] = sum;
+        }
+        for (int i = 0; i < M; ++i) {
+            U expected = 0, actual = 0;
+            for (int k = 0; k < K; ++k)
+                expected += static_cast<U>(static_cast<Acc>(A(i, k))) * br[k];
+            for (int j = 0; j < N; ++j)
+                actual += static_cast<U>(C(i, j)) * r[j];
+            if (expected != actual) {
+                result.ok = false;
+                result.round = round;
+                result.row = i;
+                result.error = 1;
+                return result;
+            }
+        }
+    }
+    return result;
+}
+
+// Floating point: in double, against a componentwise rounding bound.
+template <typename T, typename Acc, typename Rng>
+VerifyResult check_rounded(MatrixView<const T> A, MatrixView<const T> B, MatrixView<const Acc> C,
+                           int rounds, Rng& rng)
+{
+    const int M = A.rows(), K = A.cols(), N = B.cols();
+    // gamma_K = K * eps for a plain dot product; Strassen's normwise bound grows
+    // a little per level, hence the factor 8.
+    const double allowance = 8.0 * K * std::numeric_limits<Acc>::epsilon();
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> r(N), br(K), absBr(K);
+
+    VerifyResult result;
+    for (int round = 0; round < rounds; ++round) {
+        for (double& x : r)
+            x = dist(rng);
+        for (int k = 0; k < K; ++k) {
+            double sum = 0, absSum = 0;
+            for (int j = 0; j < N; ++j) {
+                sum += double(B(k, j)) * r[j];
+                absSum += std::abs(double(B(k, j)) * r[j]);
+            }
+            br[k] = sum;
+            absBr[k] = absSum;
+        }
+        for (int i = 0; i < M; ++i) {
+            double expected = 0, bound = 0, actual = 0;
+            for (int k = 0; k < K; ++k) {
+                expected += double(A(i, k)) * br[k];
+                bound += std::abs(double(A(i, k))) * absBr[k];
+            }
+            for (int j = 0; j < N; ++j)
+                actual += double(C(i, j)) * r[j];
+            double error = std::abs(expected - actual);
+            double tolerance = allowance * bound + std::numeric_limits<double>::min();
+            if (!(error <= tolerance)) {   // also catches NaN
+                result.ok = false;
+                result.round = round;
+                result.row = i;
+                result.error = error;
+                result.tolerance = tolerance;
+                return result;
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+template <typename T, typename Acc>
+void randomize_inputs(Matrix<T>& A, Matrix<T>& B, std::uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    fill_random<T, Acc>(A, A.cols(), rng);
+    fill_random<T, Acc>(B, A.cols(), rng);
+}
+
+template <typename T, typename Acc>
+VerifyResult freivalds_check(MatrixView<const T> A, MatrixView<const T> B, MatrixView<const Acc> C,
+                             int rounds, std::uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    if constexpr (std::is_floating_point<Acc>::value)
+        return check_rounded<T, Acc>(A, B, C, rounds, rng);
+    else
+        return check_exact<T, Acc>(A, B, C, rounds, rng);
+}
+
+#define CAMM_INSTANTIATE_VERIFY(T, Acc)                                                  \
+    template void randomize_inputs<T, Acc>(Matrix<T>&, Matrix<T>&, std::uint64_t);       \
+    template VerifyResult freivalds_check<T, Acc>(MatrixView<const T>, MatrixView<const T>, \
+                                                  MatrixView<const Acc>, int, std::uint64_t);
+CAMM_FOR_EACH_TYPE_PAIR(CAMM_INSTANTIATE_VERIFY)
@@ -0,0 +1,35 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include "matrix.h"
+
+#include <cstdint>
+
+// Fills A (MxK) and B (KxN) with reproducible random values. Integers stay
+// small enough that no sum of K products (nor a Strassen temporary) overflows
+// Acc; floating point is uniform in [-1, 1].
+template <typename T, typename Acc>
+void randomize_inputs(Matrix<T>& A, Matrix<T>& B, std::uint64_t seed);
+
+// Outcome of a Freivalds check; row and error describe the first mismatch.
+struct VerifyResult {
+    bool ok = true;
+    int round = -1;
+    int row = -1;
+    double error = 0;       // |A(Br) - Cr| in that row (integers: 1 for any mismatch)
+    double tolerance = 0;   // rounding allowance for that row, 0 for integers
+};
+
+/**
+ * Freivalds' check that C == A * B in O(rounds * n^2): each round compares
+ * A(Br) with Cr for a fresh random vector r. Integers are compared exactly
+ * modulo 2^bits of Acc, with r drawn from the full range, so a wrong C
+ * survives a round with probability at most 1/2 and usually about 2^-bits.
+ * Floating point is compared in double against the usual K * eps * |A||B||r|
+ * rounding bound, with headroom for Strassen.
+ */
+template <typename T, typename Acc>
+VerifyResult freivalds_check(MatrixView<const T> A, MatrixView<const T> B, MatrixView<const Acc> C,
+                             int rounds, std::uint64_t seed);
+
+#endif // VERIFY_H